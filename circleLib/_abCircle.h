@@ -12,6 +12,7 @@
 typedef struct AbCircle_s {
   void (*getBounds)(const struct AbCircle_s *circle, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbCircle_s *circle, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*spans)(const struct AbCircle_s *circle, const Vec2 *centerPos, int row, Span *spans);
   const u_char *chords;
   const u_char radius;
 } AbCircle;
@@ -24,6 +25,53 @@ void abCircleGetBounds(const AbCircle *circle, const Vec2 *circlePos, Region *bo
  */
 int abCircleCheck(const AbCircle *circle, const Vec2 *circlePos, const Vec2 *pixel);
 
+/** Required by AbShape
+ */
+int abCircleSpans(const AbCircle *circle, const Vec2 *circlePos, int row, Span *spans);
+
+/** Inline bodies of the above, for renderers built with layerRender.h
+ */
+static inline void
+abCircleGetBoundsInline(const AbCircle *circle, const Vec2 *centerPos, Region *bounds)
+{
+  int radius = circle->radius;
+  bounds->topLeft.axes[0] = centerPos->axes[0] - radius;
+  bounds->topLeft.axes[1] = centerPos->axes[1] - radius;
+  bounds->botRight.axes[0] = centerPos->axes[0] + radius;
+  bounds->botRight.axes[1] = centerPos->axes[1] + radius;
+}
+
+static inline int
+abCircleCheckInline(const AbCircle *circle, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int dCol = pixel->axes[0] - centerPos->axes[0];
+  int dRow = pixel->axes[1] - centerPos->axes[1];
+  dCol = (dCol >= 0) ? dCol : -dCol;	/* project to first quadrant */
+  dRow = (dRow >= 0) ? dRow : -dRow;
+  return dCol <= circle->radius && circle->chords[dCol] >= dRow;
+}
+
+/* the span of row inside circle: the widest column distance whose
+ * chord reaches the row, so spans agree exactly with the check */
+static inline int
+abCircleSpansInline(const AbCircle *circle, const Vec2 *centerPos, int row, Span *spans)
+{
+  int radius = circle->radius, half;
+  int dRow = row - centerPos->axes[1];
+  const u_char *chords = circle->chords;
+  dRow = (dRow >= 0) ? dRow : -dRow;
+  if (dRow > radius)
+    return 0;
+  half = chords[dRow];		/* the chords table is nearly symmetric */
+  while (half < radius && chords[half + 1] >= dRow)
+    half++;
+  while (chords[half] < dRow)	/* chords[0] == radius stops this */
+    half--;
+  spans[0].start = centerPos->axes[0] - half;
+  spans[0].end = centerPos->axes[0] + half;
+  return 1;
+}
+
 #endif
 
 
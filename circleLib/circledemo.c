@@ -3,16 +3,20 @@
 #include <lcddraw.h>
 #include "abCircle.h"
 
-AbRect rect10 = {abRectGetBounds, abRectCheck, {10,10}};; /**< 10x10 rectangle */
+AbRect rect10 = {abRectGetBounds, abRectCheck, abRectSpans, {10,10}};; /**< 10x10 rectangle */
 
 u_int bgColor = COLOR_BLUE;
 
 
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {COLOR_RED, COLOR_ORANGE}; /**< LAYER_INK indices */
+#endif
+
 Layer layer1 = {		/**< Layer with a red square */
   (AbShape *)&rect10,
   {screenWidth/2, screenHeight/2}, /**< center */
   {0,0}, {0,0},				    /* next & last pos */
-  COLOR_RED,
+  LAYER_INK(0, COLOR_RED),
   0
 };
 
@@ -20,7 +24,7 @@ Layer layer0 = {		/**< Layer with an orange circle */
   (AbShape *)&circle14,
   {(screenWidth/2)+10, (screenHeight/2)+5}, /**< bit below & right of center */
   {0,0}, {0,0},				    /* next & last pos */
-  COLOR_ORANGE,
+  LAYER_INK(1, COLOR_ORANGE),
   &layer1,
 };
 
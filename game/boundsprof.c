@@ -0,0 +1,231 @@
+/** \file boundsprof.c
+ *  \brief Host micro-benchmark: shape bounds computed per game frame
+ *
+ *  Plays the game's frame (paddle collisions, walls, goals, redraw
+ *  marking) for a number of frames twice over: once computing bounds
+ *  wherever a stage needs them, as game.c used to, and once through
+ *  the entity store's bounds cache (entity.c).  A second ball joins
+ *  for the middle third.  The shapes' getBounds count their calls;
+ *  both runs must move everything alike.
+ *
+ *  usage: boundsprof [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lcdutils.h"
+#include "shape.h"
+#include "entity.h"
+
+u_int bgColor = COLOR_BLACK;
+
+#define BALL_SPEED FX(3)
+#define PADDLE_SPEED FX(4)
+
+static unsigned long boundsCalls;
+
+static void
+countedRectGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *bounds)
+{
+  boundsCalls++;
+  abRectGetBounds(rect, centerPos, bounds);
+}
+
+const AbRect rectBall = {countedRectGetBounds, abRectCheck, abRectSpans, {2,2}};
+const AbRect rectPaddle = {countedRectGetBounds, abRectCheck, abRectSpans, {12,1}};
+const AbRectOutline outlineField = {
+  abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineSpans,
+  {screenWidth/2 - 10, screenHeight/2 - 1}
+};
+
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {COLOR_WHITE}; /**< LAYER_INK indices */
+#endif
+
+Layer layerField = {(AbShape *)&outlineField, {screenWidth/2, screenHeight/2}, {0,0}, {0,0}, LAYER_INK(0, COLOR_WHITE), 0};
+
+static EntityStore store;
+static u_char ball, paddleLeft, paddleRight;
+static Region fieldFence;
+static DirtyList dirty;
+static int cached;		/* which way the stages get bounds */
+
+/** Bounds of entity i's shape at pos + velocity, the way a stage asks */
+static const Region *
+boundsNext(u_char i, Region *scratch)
+{
+  Vec2Fx newPos;
+  Vec2 pixelPos;
+  if (cached)
+    return entityBoundsNext(&store, i);
+  vec2FxAdd(&newPos, &store.pos[i], &store.velocity[i]);
+  vec2FxRound(&pixelPos, &newPos);
+  abShapeGetBounds(store.layers[i].abShape, &pixelPos, scratch);
+  return scratch;
+}
+
+/** Bounds of entity i where its layer is drawn */
+static const Region *
+boundsDrawn(u_char i, Region *scratch)
+{
+  Vec2 at;
+  if (cached)
+    return &store.boundsDrawn[i];
+  abShapeGetBounds(store.layers[i].abShape, LAYER_VEC2(store.layers[i].pos, at), scratch);
+  return scratch;
+}
+
+static void
+collidePaddle(u_char paddle, char top)
+{
+  Region b, p;
+  const Region *ballEdge = boundsNext(ball, &b);
+  const Region *paddleEdge = boundsDrawn(paddle, &p);
+  char hit = top			/* the game's HandleCollidePaddle* */
+    ? boundsNext(ball, &b)->topLeft.axes[1] < boundsDrawn(paddle, &p)->botRight.axes[1]
+    : boundsNext(ball, &b)->botRight.axes[1] > boundsDrawn(paddle, &p)->topLeft.axes[1];
+  if (hit
+      && ballEdge->botRight.axes[0] > paddleEdge->topLeft.axes[0]
+      && ballEdge->topLeft.axes[0] < paddleEdge->botRight.axes[0]) {
+    Vec2Fx newPos;
+    vec2FxAdd(&newPos, &store.pos[ball], &store.velocity[ball]);
+    store.velocity[ball].axes[1] = -store.velocity[ball].axes[1];
+    newPos.axes[1] += store.velocity[ball].axes[1];
+    entitySetPos(&store, ball, &newPos);
+  }
+}
+
+static void
+collideWalls()
+{
+  u_char i;
+  for (i = 0; i < store.count; i++) {
+    Region scratch;
+    const Region *edge = boundsNext(i, &scratch);
+    if (edge->topLeft.axes[0] < fieldFence.topLeft.axes[0]
+	|| edge->botRight.axes[0] > fieldFence.botRight.axes[0])
+      store.velocity[i].axes[0] = -store.velocity[i].axes[0];
+  }
+  entityIntegrate(&store);
+}
+
+static void
+collideGoals(u_char i)
+{
+  Region scratch;
+  const Region *edge = boundsNext(i, &scratch);
+  char goal = 0;
+  if (edge->topLeft.axes[1] < fieldFence.topLeft.axes[1]) {
+    goal = 1;
+    store.velocity[i].axes[1] = BALL_SPEED;
+  }
+  if (edge->botRight.axes[1] > fieldFence.botRight.axes[1]) {
+    goal = 1;
+    store.velocity[i].axes[1] = -BALL_SPEED;
+  }
+  if (goal) {
+    Vec2Fx center = {FX(screenWidth/2), FX(screenHeight/2)};
+    entitySetPos(&store, i, &center);
+  }
+}
+
+static void
+markDirty()
+{
+  u_char i;
+  entityCommit(&store);
+  if (cached)
+    entityAddDirty(&store, &dirty);
+  else
+    for (i = 0; i < store.count; i++)
+      dirtyAddLayer(&dirty, &store.layers[i]);
+}
+
+/** Steer a paddle the way the watchdog handler does */
+static void
+steer(u_char paddle, int speed)
+{
+  if (store.velocity[paddle].axes[0] != speed) {
+    store.velocity[paddle].axes[0] = speed;
+    store.gen[paddle]++;
+  }
+}
+
+static void
+sceneInit()
+{
+  Vec2 at = {screenWidth/2, screenHeight/2};
+  entityInit(&store, &layerField);
+  ball = entityAdd(&store, (AbShape *)&rectBall, LAYER_INK(0, COLOR_WHITE), &at);
+  at.axes[1] = screenHeight - 10;
+  paddleRight = entityAdd(&store, (AbShape *)&rectPaddle, LAYER_INK(0, COLOR_WHITE), &at);
+  at.axes[1] = 10;
+  paddleLeft = entityAdd(&store, (AbShape *)&rectPaddle, LAYER_INK(0, COLOR_WHITE), &at);
+  store.velocity[ball].axes[0] = FX(1);
+  store.velocity[ball].axes[1] = -BALL_SPEED;
+  layerInit(entityLayers(&store));
+  layerGetBounds(&layerField, &fieldFence);
+  dirtyInit(&dirty);
+}
+
+/** Play frames, printing bounds per frame; a second ball joins for
+ *  the middle third.  Returns a sum of positions and areas to compare.
+ */
+static long
+run(int frames, int useCache)
+{
+  unsigned long physics = 0, marking = 0;
+  long positions = 0;
+  int frame, second = -1;
+  u_char i;
+
+  cached = useCache;
+  sceneInit();
+  for (frame = 0; frame < frames; frame++) {
+    if (frame == frames / 3) {
+      Vec2 at = {30, 50};
+      second = entityAdd(&store, (AbShape *)&rectBall, LAYER_INK(0, COLOR_WHITE), &at);
+      store.velocity[second].axes[0] = -FX(2);
+      store.velocity[second].axes[1] = BALL_SPEED;
+    } else if (frame == 2 * frames / 3 && second >= 0) {
+      entityRemove(&store, second, &dirty);
+      second = -1;
+    }
+    steer(paddleLeft, (frame / 16) % 3 == 0 ? -PADDLE_SPEED : (frame / 16) % 3 == 1 ? PADDLE_SPEED : 0);
+    steer(paddleRight, (frame / 24) % 2 ? PADDLE_SPEED : -PADDLE_SPEED);
+    boundsCalls = 0;
+    collidePaddle(paddleLeft, 1);
+    collidePaddle(paddleRight, 0);
+    collideWalls();
+    collideGoals(ball);
+    if (second >= 0)
+      collideGoals(second);
+    physics += boundsCalls;
+    boundsCalls = 0;
+    markDirty();
+    marking += boundsCalls;
+    positions += dirty.pixelsPending; /* not drawn: only the stages are measured */
+    dirtyInit(&dirty);
+    for (i = 0; i < store.count; i++)
+      positions += (i + 1) * (store.layers[i].pos.axes[0] * 7 + store.layers[i].pos.axes[1] * 3);
+  }
+  if (frames)
+    printf("%s: %d frames: %lu.%02lu bounds per frame (physics %lu.%02lu, redraw marking %lu.%02lu)\n",
+	   useCache ? "cached" : "direct", frames,
+	   (physics + marking) / frames, (physics + marking) * 100 / frames % 100,
+	   physics / frames, physics * 100 / frames % 100,
+	   marking / frames, marking * 100 / frames % 100);
+  return positions;
+}
+
+int
+main(int argc, char **argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 600;
+  long direct = run(frames, 0), withCache = run(frames, 1);
+  if (direct != withCache) {
+    printf("boundsprof: the runs moved differently\n");
+    return 1;
+  }
+  return 0;
+}
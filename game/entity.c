@@ -0,0 +1,113 @@
+#include "entity.h"
+
+/** Chain the layers front to back, ahead of back (private) */
+static void
+entityLink(EntityStore *store)
+{
+  u_char i;
+  for (i = 0; i < store->count; i++)
+    store->layers[i].next = i + 1 < store->count ? &store->layers[i + 1] : store->back;
+}
+
+void
+entityInit(EntityStore *store, Layer *back)
+{
+  store->count = 0;
+  store->back = back;
+}
+
+int
+entityAdd(EntityStore *store, AbShape *shape, LayerColor color, const Vec2 *pos)
+{
+  u_char i = store->count;
+  Layer *l = &store->layers[i];
+  if (i == ENTITY_MAX)
+    return -1;
+  vec2FxFromVec2(&store->pos[i], pos);
+  store->velocity[i].axes[0] = store->velocity[i].axes[1] = 0;
+  abShapeGetBounds(shape, pos, &store->boundsDrawn[i]);
+  store->boundsGen[i] = store->gen[i] - 1; /* nothing cached */
+  l->abShape = shape;
+  l->color = color;
+  l->flags = 0;
+  LAYER_VEC_SET(l->pos, *pos);
+  l->posLast = l->posNext = l->pos;
+  store->count++;
+  entityLink(store);
+  return i;
+}
+
+void
+entityRemove(EntityStore *store, u_char i, DirtyList *dirty)
+{
+  u_char last = --store->count;
+  dirtyAdd(dirty, &store->boundsDrawn[i]);
+  store->pos[i] = store->pos[last];
+  store->velocity[i] = store->velocity[last];
+  store->boundsNext[i] = store->boundsNext[last];
+  store->boundsDrawn[i] = store->boundsDrawn[last];
+  store->gen[i] = store->gen[last];
+  store->boundsGen[i] = store->boundsGen[last];
+  store->layers[i] = store->layers[last];
+  entityLink(store);
+}
+
+const Region *
+entityBoundsNext(EntityStore *store, u_char i)
+{
+  u_char gen = store->gen[i];	/* before velocity: an interrupt may steer */
+  if (store->boundsGen[i] != gen) {
+    Vec2Fx posNext;
+    Vec2 pixelPos;
+    vec2FxAdd(&posNext, &store->pos[i], &store->velocity[i]);
+    vec2FxRound(&pixelPos, &posNext);
+    abShapeGetBounds(store->layers[i].abShape, &pixelPos, &store->boundsNext[i]);
+    store->boundsGen[i] = gen;
+  }
+  return &store->boundsNext[i];
+}
+
+void
+entitySetPos(EntityStore *store, u_char i, const Vec2Fx *pos)
+{
+  store->pos[i] = *pos;
+  layerSetPosFx(&store->layers[i], pos);
+  store->gen[i]++;
+}
+
+void
+entityIntegrate(EntityStore *store)
+{
+  u_char i;
+  for (i = 0; i < store->count; i++) {
+    vec2FxAdd(&store->pos[i], &store->pos[i], &store->velocity[i]);
+    layerSetPosFx(&store->layers[i], &store->pos[i]);
+    store->gen[i]++;
+  }
+}
+
+void
+entityCommit(EntityStore *store)
+{
+  u_char i;
+  for (i = 0; i < store->count; i++) {
+    Layer *l = &store->layers[i];
+    l->posLast = l->pos;
+    l->pos = l->posNext;
+  }
+}
+
+void
+entityAddDirty(EntityStore *store, DirtyList *dirty)
+{
+  u_char i;
+  for (i = 0; i < store->count; i++) {
+    Layer *l = &store->layers[i];
+    Region bounds = store->boundsDrawn[i];
+    Vec2 at;
+    if (l->pos.axes[0] != l->posLast.axes[0] || l->pos.axes[1] != l->posLast.axes[1])
+      abShapeGetBounds(l->abShape, LAYER_VEC2(l->pos, at), &bounds);
+    dirtyAddMove(dirty, &bounds, &store->boundsDrawn[i]);
+    store->boundsDrawn[i] = bounds;
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include <shape.h>
+
+#ifndef ENTITY_MAX
+#define ENTITY_MAX 4		/**< most moving objects at once (-D to change) */
+#endif
+
+/** The game's moving objects, one index each, in parallel arrays
+ *
+ *  Physics passes loop over indices 0..count-1.  Each entity also
+ *  owns a Layer in layers, which holds its shape and color; those are
+ *  chained front to back, in index order, ahead of back, so
+ *  entityLayers() can be drawn and flushed like any layer list.
+ *  Adding or removing an entity changes the depth of back's layers:
+ *  bake them again if they are baked.
+ *
+ *  Bounds are cached: boundsNext, the shape's bounds at pos +
+ *  velocity, is computed once per change of either.  Changes are
+ *  counted in gen: entitySetPos and entityIntegrate bump it, and so
+ *  must anything that writes pos or velocity directly.  boundsNext[i]
+ *  is current while boundsGen[i] equals gen[i].
+ */
+typedef struct {
+  u_char count;
+  Vec2Fx pos[ENTITY_MAX];	/**< sub-pixel position, rounded into layers */
+  Vec2Fx velocity[ENTITY_MAX];	/**< per physics tick */
+  Region boundsNext[ENTITY_MAX]; /**< at pos + velocity, rounded */
+  Region boundsDrawn[ENTITY_MAX]; /**< at the layer's pos: on screen */
+  u_char gen[ENTITY_MAX], boundsGen[ENTITY_MAX];
+  Layer layers[ENTITY_MAX];	/**< the renderer's view of each entity */
+  Layer *back;			/**< layers behind the entities */
+} EntityStore;
+
+/** Empty the store; its layer list is just back */
+void entityInit(EntityStore *store, Layer *back);
+
+/** Add an entity at rest at pos, behind the others (next index)
+ *
+ *  \return its index, or -1 if the store is full
+ */
+int entityAdd(EntityStore *store, AbShape *shape, LayerColor color, const Vec2 *pos);
+
+/** Remove entity i, marking where it was drawn in dirty; the last
+ *  entity takes its index
+ */
+void entityRemove(EntityStore *store, u_char i, DirtyList *dirty);
+
+/** The entities' layers, then back */
+#define entityLayers(store) ((store)->count ? (store)->layers : (store)->back)
+
+/** Entity i's bounds at pos + velocity, rounded as it would be drawn */
+const Region *entityBoundsNext(EntityStore *store, u_char i);
+
+/** Move entity i to pos (sub-pixel), setting its layer's posNext */
+void entitySetPos(EntityStore *store, u_char i, const Vec2Fx *pos);
+
+/** Advance every entity by its velocity */
+void entityIntegrate(EntityStore *store);
+
+/** Make each layer's posNext its pos, remembering the last in posLast */
+void entityCommit(EntityStore *store);
+
+/** Mark what each entity's move from boundsDrawn changed in dirty,
+ *  after entityCommit; bounds are recomputed only for layers that
+ *  moved
+ */
+void entityAddDirty(EntityStore *store, DirtyList *dirty);
+
+#endif // ENTITY_H
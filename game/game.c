@@ -2,14 +2,22 @@
 #include <libTimer.h>
 #include <lcdutils.h>
 #include <lcddraw.h>
+#include <lcdtext.h>
 #include <shape.h>
 #include <abCircle.h>
 #include <p2switches.h>
 #include <sound.h>
 #include "game.h"
 
+/* Renderer with the scene's shape types inlined (see layerRender.h) */
+#define LAYER_RENDER_NAME GameDrawRows
+#define LAYER_RENDER_SHAPES(X) X(AbRect, abRect) X(AbRectOutline, abRectOutline) X(AbCircle, abCircle)
+#define LAYER_RENDER_ROW_PIXELS 16	/* 64 B of stack: the ball's dirty rows, sent while the next is composed */
+#include <layerRender.h>
+
 #define RED_LED BIT6
-#define BALL_SPEED 3
+#define BALL_SPEED FX(3)
+#define PADDLE_SPEED FX(4)
 
 static Region              fieldFence;
 
@@ -19,20 +27,32 @@ int                        redrawScreen          = 0;
 static short               count                 = 0;
 static unsigned int        scorePlayerLeft       = 0;
 static unsigned int        scorePlayerRight      = 0;
+static TextField           textScoreLeft;
+static TextField           textScoreRight;
+static DirtyList           dirty;                   /**< per-frame redraw rectangles */
+static LayerRun            backgroundRuns[9];       /**< the field bakes to 9 runs */
+static LayerBand           backgroundBands[4];      /**< in 4 bands of alike rows */
+static LayerBackground     background            = {backgroundRuns, backgroundBands, 9, 4};
+#ifdef SHAPE_COMPACT
+const u_int                layerPalette[]        = {COLOR_BLACK, COLOR_WHITE}; /**< LAYER_INK indices */
+#endif
 
 const static AbRect        rectPaddleRight       = {
                                                     abRectGetBounds,
                                                     abRectCheck,
+                                                    abRectSpans,
                                                     {12,1}
 };
 const static AbRect        rectPaddleLeft        = {
                                                     abRectGetBounds,
                                                     abRectCheck,
+                                                    abRectSpans,
                                                     {12,1}
 };
 const static AbRectOutline outlineField          = {
                                                     abRectOutlineGetBounds,
                                                     abRectOutlineCheck,
+                                                    abRectOutlineSpans,
                                                     {
                                                      screenWidth/2 - 10,
                                                      screenHeight/2 - 1
@@ -42,49 +62,14 @@ static Layer               layerField            = {
                                                     (AbShape *) &outlineField,
                                                     {screenWidth/2, screenHeight/2},
                                                     {0,0}, {0,0},
-                                                    COLOR_WHITE,
-                                                    0
-};
-static Layer               layerPaddleLeft        = {
-                                                     (AbShape *)&rectPaddleLeft,
-                                                     {screenWidth/2, 10},
-                                                     {0,0}, {0,0},
-                                                     COLOR_WHITE,
-                                                     &layerField,
-};
-static Layer               layerPaddleRight       = {
-                                                     (AbShape *)&rectPaddleRight,
-                                                     {screenWidth/2, screenHeight-10},
-                                                     {0,0}, {0,0},
-                                                     COLOR_WHITE,
-                                                     &layerPaddleLeft,
-};
-static Layer               layerBall               = {
-                                                      (AbShape *)&circle2,
-                                                      {(screenWidth/2), (screenHeight/2)},
-                                                      {0,0}, {0,0},
-                                                      COLOR_WHITE,
-                                                      &layerPaddleRight,
-};
-
-static transform_t         transformPaddleLeft      = {
-                                                       &layerPaddleLeft,
-                                                       { 0 , 0 },
-                                                       HandleCollidePaddleLeft,
-                                                       0
-};
-static transform_t         transformPaddleRight     = {
-                                                       &layerPaddleRight,
-                                                       { 0 , 0 },
-                                                       HandleCollidePaddleRight,
-                                                       &transformPaddleLeft
-};
-static transform_t         transformBall            = {
-                                                       &layerBall,
-                                                       { 1 , -BALL_SPEED },
-                                                       0,
-                                                       &transformPaddleRight
+                                                    LAYER_INK(1, COLOR_WHITE),
+                                                    0,
+                                                    LAYER_STATIC
 };
+static EntityStore         entities;                /**< ball and paddles, ahead of the field */
+static u_char              ball;
+static u_char              paddleLeft;
+static u_char              paddleRight;
 
 /*
 ========================================
@@ -109,80 +94,61 @@ static void IsGameOver() {
   return;
 }
 
+/*
+========================================
+GameDrawRegion
+
+  Render layers within area using the
+  specialized renderer.
+========================================
+*/
+static void GameDrawRegion(Layer *layers, const Region *area)
+{
+  GameDrawRows(layers, area, 0);
+}
+
 /*
 ========================================
 DoRenderLayers
 
   Redraw layers based on updated
-  transform components.
+  entity positions.
 ========================================
 */
-static void DoRenderLayers(transform_t *transforms, Layer *layers)
+static void DoRenderLayers(EntityStore *store)
 {
-  int row, col;
-  transform_t *transform;
-
   and_sr(~8);			/**< disable interrupts (GIE off) */
-  for (transform = transforms; transform; transform = transform->next) { /* for each moving layer */
-    Layer *l = transform->layer;
-    l->posLast = l->pos;
-    l->pos = l->posNext;
-  }
+  entityCommit(store);
   or_sr(8);			/**< disable interrupts (GIE on) */
 
-  for (transform = transforms; transform; transform = transform->next) { /* for each moving layer */
-    Region bounds;
-    layerGetBounds(transform->layer, &bounds);
-    lcd_setArea(bounds.topLeft.axes[0], bounds.topLeft.axes[1],
-		bounds.botRight.axes[0], bounds.botRight.axes[1]);
-    for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
-      for (col = bounds.topLeft.axes[0]; col <= bounds.botRight.axes[0]; col++) {
-	Vec2 pixelPos = {col, row};
-	u_int color = bgColor;
-	Layer *probeLayer;
-	for (probeLayer = layers; probeLayer;
-	     probeLayer = probeLayer->next) { /* probe all layers, in order */
-	  if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	    color = probeLayer->color;
-	    break;
-	  } /* if probe check */
-	} // for checking all layers at col, row
-	lcd_writeColor(color);
-      } // for col
-    } // for row
-  } // for moving layer being updated
+  entityAddDirty(store, &dirty);
+  dirtyFlushWith(&dirty, entityLayers(store), GameDrawRegion); /**< overlapping bounds drawn once */
 }
 
 /*
 ========================================
 DoCollideWalls
 
-  Apply transforms to geometry layers
-  and check horizontal wall collisions.
+  Turn entities back from the side
+  walls, then move every entity.
 ========================================
 */
-static inline void DoCollideWalls(transform_t *transform, Region *fence)
+static inline void DoCollideWalls(EntityStore *store, Region *fence)
 {
-  Vec2 newPos;
-  u_char axis;
-  Region shapeBoundary;
-  for (; transform; transform = transform->next) {
-
-    vec2Add( &newPos, &transform->layer->posNext, &transform->velocity );
-    abShapeGetBounds( transform->layer->abShape, &newPos, &shapeBoundary );
+  u_char i;
+  for (i = 0; i < store->count; i++) {
+    const Region *shapeBoundary = entityBoundsNext( store, i );
 
     if (
-        shapeBoundary.topLeft.axes[0]  < fence->topLeft.axes[0]      ||
-        shapeBoundary.botRight.axes[0] > fence->botRight.axes[0]
+        shapeBoundary->topLeft.axes[0]  < fence->topLeft.axes[0]      ||
+        shapeBoundary->botRight.axes[0] > fence->botRight.axes[0]
         )
       {
         set_buzzer(900);
-        int velocity = transform->velocity.axes[0] = -transform->velocity.axes[0];
-        newPos.axes[0] += (2*velocity);
+        store->velocity[i].axes[0] = -store->velocity[i].axes[0];
       }
-
-    transform->layer->posNext = newPos;
-  } /**< for transform */
+  } /**< for entity */
+  entityIntegrate(store);
 }
 
 /*
@@ -192,31 +158,27 @@ DoCollideGoals
   Check vertical ball - wall collisions.
 ========================================
 */
-static inline void DoCollideGoals(transform_t *ball, Region *goal)
+static inline void DoCollideGoals(EntityStore *store, u_char ball, Region *goal)
 {
   unsigned char goalTouched = 0;
-  Vec2 newPos;
-  u_char axis;
-  Region ballEdge;
+  const Region *ballEdge = entityBoundsNext( store, ball );
 
-  vec2Add( &newPos, &ball->layer->posNext, &ball->velocity );
-  abShapeGetBounds( ball->layer->abShape, &newPos, &ballEdge );
-  if ( ballEdge.topLeft.axes[1] < goal->topLeft.axes[1] ) {
+  if ( ballEdge->topLeft.axes[1] < goal->topLeft.axes[1] ) {
     goalTouched = 1;
     scorePlayerRight ++;
-    ball->velocity.axes[1] = BALL_SPEED;
+    store->velocity[ball].axes[1] = BALL_SPEED;
   }
 
-  if ( ballEdge.botRight.axes[1] > goal->botRight.axes[1] ) {
+  if ( ballEdge->botRight.axes[1] > goal->botRight.axes[1] ) {
     goalTouched = 1;
     scorePlayerLeft ++;
-    ball->velocity.axes[1] = -BALL_SPEED;
+    store->velocity[ball].axes[1] = -BALL_SPEED;
   }
 
   if ( goalTouched ) {
+    Vec2Fx center = {FX(screenWidth/2), FX(screenHeight/2)};
     set_buzzer(600);
-    ball->layer->posNext.axes[0] = screenWidth/2;
-    ball->layer->posNext.axes[1] = screenHeight/2;
+    entitySetPos(store, ball, &center);
     IsGameOver();
     count = -300;
   }
@@ -232,14 +194,10 @@ HandleCollidePaddleLeft
   left player.
 ========================================
 */
-static char HandleCollidePaddleLeft(transform_t *ball, transform_t *paddle) {
-  Vec2 newPos;
-  Region ballEdge;
-  Region paddleEdge;
-  vec2Add(&newPos, &ball->layer->posNext, &ball->velocity);
-  abShapeGetBounds(ball->layer->abShape, &newPos, &ballEdge);
-  abShapeGetBounds(paddle->layer->abShape, &paddle->layer->pos, &paddleEdge);
-  if ( ballEdge.topLeft.axes[1] < paddleEdge.botRight.axes[1] )
+static char HandleCollidePaddleLeft(EntityStore *store, u_char ball, u_char paddle) {
+  const Region *ballEdge = entityBoundsNext(store, ball);
+  const Region *paddleEdge = &store->boundsDrawn[paddle];
+  if ( ballEdge->topLeft.axes[1] < paddleEdge->botRight.axes[1] )
     return 1;
   return 0;
 }
@@ -252,14 +210,10 @@ HandleCollidePaddleRight
   right player.
 ========================================
 */
-static char HandleCollidePaddleRight(transform_t *ball, transform_t *paddle) {
-  Vec2 newPos;
-  Region ballEdge;
-  Region paddleEdge;
-  vec2Add(&newPos, &ball->layer->posNext, &ball->velocity);
-  abShapeGetBounds(ball->layer->abShape, &newPos, &ballEdge);
-  abShapeGetBounds(paddle->layer->abShape, &paddle->layer->pos, &paddleEdge);
-  if ( ballEdge.botRight.axes[1] > paddleEdge.topLeft.axes[1] )
+static char HandleCollidePaddleRight(EntityStore *store, u_char ball, u_char paddle) {
+  const Region *ballEdge = entityBoundsNext(store, ball);
+  const Region *paddleEdge = &store->boundsDrawn[paddle];
+  if ( ballEdge->botRight.axes[1] > paddleEdge->topLeft.axes[1] )
     return 1;
   return 0;
 }
@@ -268,28 +222,28 @@ static char HandleCollidePaddleRight(transform_t *ball, transform_t *paddle) {
 ========================================
 DoCollidePaddle
 
-  Generic paddle collision check.
+  Generic paddle collision check, with
+  the paddle's side test.
 ========================================
 */
-static inline void DoCollidePaddle(transform_t *ball, transform_t *paddle)
+static inline void DoCollidePaddle(EntityStore *store, u_char ball, u_char paddle,
+                                   char (*CollisionCheck)(EntityStore *, u_char, u_char))
 {
-  Vec2 newPos;
-  Region ballEdge;
-  Region paddleEdge;
-  vec2Add(&newPos, &ball->layer->posNext, &ball->velocity);
-  abShapeGetBounds(ball->layer->abShape, &newPos, &ballEdge);
-  abShapeGetBounds(paddle->layer->abShape, &paddle->layer->pos, &paddleEdge);
+  Vec2Fx newPos;
+  const Region *ballEdge = entityBoundsNext(store, ball);
+  const Region *paddleEdge = &store->boundsDrawn[paddle]; /**< where its layer is now */
   if (
-      paddle->CollisionCheck(ball, paddle)                     &&
-      ballEdge.botRight.axes[0] > paddleEdge.topLeft.axes[0]   &&
-      ballEdge.topLeft.axes[0]  < paddleEdge.botRight.axes[0]
+      CollisionCheck(store, ball, paddle)                      &&
+      ballEdge->botRight.axes[0] > paddleEdge->topLeft.axes[0] &&
+      ballEdge->topLeft.axes[0]  < paddleEdge->botRight.axes[0]
       )
     {
       set_buzzer(440);
       int velocity;
-      velocity = ball->velocity.axes[1] = -ball->velocity.axes[1];
+      vec2FxAdd(&newPos, &store->pos[ball], &store->velocity[ball]);
+      velocity = store->velocity[ball].axes[1] = -store->velocity[ball].axes[1];
       newPos.axes[1] += (velocity);
-      ball->layer->posNext = newPos;
+      entitySetPos(store, ball, &newPos);
     }
 }
 
@@ -322,10 +276,20 @@ void main() {
   init_buzzer();
   shapeInit();
 
-  // Initialize Geometry Layers
-  layerInit(&layerBall);
-  layerDraw(&layerBall);
+  // Initialize Geometry Layers, front to back
+  entityInit(&entities, &layerField);
+  ball = entityAdd(&entities, (AbShape *)&circle2, LAYER_INK(1, COLOR_WHITE), &(Vec2){screenWidth/2, screenHeight/2});
+  paddleRight = entityAdd(&entities, (AbShape *)&rectPaddleRight, LAYER_INK(1, COLOR_WHITE), &(Vec2){screenWidth/2, screenHeight-10});
+  paddleLeft = entityAdd(&entities, (AbShape *)&rectPaddleLeft, LAYER_INK(1, COLOR_WHITE), &(Vec2){screenWidth/2, 10});
+  entities.velocity[ball].axes[0] = FX(1);
+  entities.velocity[ball].axes[1] = -BALL_SPEED;
+  layerInit(entityLayers(&entities));
+  layerBakeStatic(entityLayers(&entities), &background); // Field leaves the probe loop
+  layerDraw(entityLayers(&entities));
   layerGetBounds(&layerField, &fieldFence);
+  textFieldInit(&textScoreLeft, 3, 20, COLOR_WHITE, COLOR_BLACK);
+  textFieldInit(&textScoreRight, screenWidth-7, screenHeight-20, COLOR_WHITE, COLOR_BLACK);
+  dirtyInit(&dirty);
 
   // Enable automatic dog feeder
   enableWDTInterrupts();
@@ -333,6 +297,9 @@ void main() {
   // Enable Interrupts
   or_sr(0x8);
 
+  // Let the SPI bus drain under interrupt while physics runs
+  lcd_setTxQueue(1);
+
   /*
   ====================
 
@@ -352,17 +319,15 @@ void main() {
 
     // Handle Physics in sync with Watchdog
     redrawScreen = 0;
-    DoCollidePaddle(&transformBall, &transformPaddleLeft);
-    DoCollidePaddle(&transformBall, &transformPaddleRight);
-    DoCollideWalls(&transformBall, &fieldFence);
-    DoCollideGoals(&transformBall, &fieldFence);
-    DoRenderLayers(&transformBall, &layerBall);
-
-    // Update Score Charts
-    char scoreStringLeft [2] = { '0'+scorePlayerLeft, '\0' };
-    drawString5x7(3, 20, scoreStringLeft, COLOR_WHITE, COLOR_BLACK);
-    char scoreStringRight [2] = { '0'+scorePlayerRight, '\0' };
-    drawString5x7(screenWidth-7, screenHeight-20, scoreStringRight, COLOR_WHITE, COLOR_BLACK);
+    DoCollidePaddle(&entities, ball, paddleLeft, HandleCollidePaddleLeft);
+    DoCollidePaddle(&entities, ball, paddleRight, HandleCollidePaddleRight);
+    DoCollideWalls(&entities, &fieldFence);
+    DoCollideGoals(&entities, ball, &fieldFence);
+    DoRenderLayers(&entities);
+
+    // Update Score Charts (only sends glyphs that changed)
+    textFieldSetUInt(&textScoreLeft, scorePlayerLeft);
+    textFieldSetUInt(&textScoreRight, scorePlayerRight);
 
     // Stop Sounds in sync with Watchdog
     stop_buzzer();
@@ -370,6 +335,22 @@ void main() {
 }
 
 
+/*
+========================================
+SetPaddleSpeed
+
+  Steer a paddle; a new velocity
+  invalidates its cached bounds.
+========================================
+*/
+static void SetPaddleSpeed(u_char paddle, int speed)
+{
+  if (entities.velocity[paddle].axes[0] != speed) {
+    entities.velocity[paddle].axes[0] = speed;
+    entities.gen[paddle]++;
+  }
+}
+
 /*
 ========================================
 wdt_c_handler
@@ -385,18 +366,18 @@ void wdt_c_handler() {
     unsigned int state = p2sw_read();
 
     if (!(state & 4))
-      transformPaddleRight.velocity.axes[0] = -4;
+      SetPaddleSpeed(paddleRight, -PADDLE_SPEED);
     else if (!(state & 8))
-      transformPaddleRight.velocity.axes[0] = 4;
+      SetPaddleSpeed(paddleRight, PADDLE_SPEED);
     else {
-      transformPaddleRight.velocity.axes[0] = 0;
+      SetPaddleSpeed(paddleRight, 0);
     }
     if (!(state & 1))
-      transformPaddleLeft.velocity.axes[0] = -4;
+      SetPaddleSpeed(paddleLeft, -PADDLE_SPEED);
     else if (!(state & 2))
-      transformPaddleLeft.velocity.axes[0] = 4;
+      SetPaddleSpeed(paddleLeft, PADDLE_SPEED);
     else {
-      transformPaddleLeft.velocity.axes[0] = 0;
+      SetPaddleSpeed(paddleLeft, 0);
     }
     redrawScreen = 1;
     count = 0;
@@ -2,15 +2,9 @@
 #define GAME_H
 
 #include <shape.h>
+#include "entity.h"
 
-typedef struct transform_s {
-  Layer *layer;
-  Vec2 velocity;
-  char (*CollisionCheck)(struct transform_s*, struct transform_s*);
-  struct transform_s *next;
-} transform_t;
-
-static char HandleCollidePaddleLeft(struct transform_s *ball, struct transform_s *paddle);
-static char HandleCollidePaddleRight(struct transform_s *ball, struct transform_s *paddle);
+static char HandleCollidePaddleLeft(EntityStore *store, u_char ball, u_char paddle);
+static char HandleCollidePaddleRight(EntityStore *store, u_char ball, u_char paddle);
 
 #endif // GAME_H
@@ -0,0 +1,55 @@
+/** \file hostdemo.c
+ *  \brief lcddemo on the host: draws the same strings, square and sprite into
+ *  the emulated controller, reports bus traffic and writes lcddemo.ppm
+ */
+
+#include <stdio.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "lcdsprite.h"
+#include "st7735emu.h"
+
+/** An 8x8 face at 2 bits per pixel; index 0 is transparent */
+static const u_int facePalette[4] = {
+  COLOR_BLACK, COLOR_YELLOW, COLOR_BLACK, COLOR_RED
+};
+static const u_char facePixels[8 * 2] = {
+  0x05, 0x50,  0x15, 0x54,  0x59, 0x65,  0x55, 0x55,
+  0x75, 0x5d,  0x5f, 0xf5,  0x15, 0x54,  0x05, 0x50
+};
+static const Sprite face = { 8, 8, 2, 0, facePalette, facePixels };
+
+int
+main()
+{
+  lcd_init();
+  st7735_printStats(stdout, "lcd_init");
+
+  st7735_resetStats();
+  clearScreen(COLOR_BLUE);
+  st7735_printStats(stdout, "clearScreen");
+
+  st7735_resetStats();
+  drawString5x7(20,20, "hello", COLOR_GREEN, COLOR_RED);
+  st7735_printStats(stdout, "drawString5x7");
+
+  st7735_resetStats();
+  fillRectangle(30,30, 60, 60, COLOR_ORANGE);
+  st7735_printStats(stdout, "fillRectangle");
+
+  st7735_resetStats();
+  drawString8x12(20,100, "8x12", COLOR_WHITE, COLOR_BLUE);
+  st7735_printStats(stdout, "drawString8x12");
+
+  st7735_resetStats();
+  drawString11x16(20,120, "11x16", COLOR_YELLOW, COLOR_BLUE);
+  st7735_printStats(stdout, "drawString11x16");
+
+  st7735_resetStats();
+  drawSprite(80,30, &face);
+  drawSprite(124,40, &face);
+  st7735_printStats(stdout, "drawSprite");
+
+  lcd_flush();			/* a 12 bit odd pixel may still be waiting */
+  return st7735_writePPM("lcddemo.ppm");
+}
@@ -1,10 +1,21 @@
 /** \file lcddemo.c
- *  \brief A simple demo that draws a string and square
+ *  \brief A simple demo that draws strings, a square and a sprite
  */
 
 #include <libTimer.h>
 #include "lcdutils.h"
 #include "lcddraw.h"
+#include "lcdsprite.h"
+
+/** An 8x8 face at 2 bits per pixel; index 0 is transparent */
+static const u_int facePalette[4] = {
+  COLOR_BLACK, COLOR_YELLOW, COLOR_BLACK, COLOR_RED
+};
+static const u_char facePixels[8 * 2] = {
+  0x05, 0x50,  0x15, 0x54,  0x59, 0x65,  0x55, 0x55,
+  0x75, 0x5d,  0x5f, 0xf5,  0x15, 0x54,  0x05, 0x50
+};
+static const Sprite face = { 8, 8, 2, 0, facePalette, facePixels };
 
 /** Initializes everything, clears the screen, draws "hello" and a square */
 int
@@ -19,5 +30,11 @@ main()
   drawString5x7(20,20, "hello", COLOR_GREEN, COLOR_RED);
 
   fillRectangle(30,30, 60, 60, COLOR_ORANGE);
+
+  drawString8x12(20,100, "8x12", COLOR_WHITE, COLOR_BLUE);
+  drawString11x16(20,120, "11x16", COLOR_YELLOW, COLOR_BLUE);
+
+  drawSprite(80,30, &face);
+  drawSprite(124,40, &face);	/* clipped by the right edge */
   
 }
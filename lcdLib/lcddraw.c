@@ -30,11 +30,7 @@ void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height,
 {
   u_char colLimit = colMin + width, rowLimit = rowMin + height;
   lcd_setArea(colMin, rowMin, colLimit - 1, rowLimit - 1);
-  u_int total = width * height;
-  u_int c = 0;
-  while ((c++) < total) {
-    lcd_writeColor(colorBGR);
-  }
+  lcd_fillRun(colorBGR, (u_int)width * height);
 }
 
 /** Clear screen (fill with color)
@@ -43,9 +39,8 @@ void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height,
  */
 void clearScreen(u_int colorBGR) 
 {
-  u_char w = screenWidth;
-  u_char h = screenHeight;
-  fillRectangle(0, 0, screenWidth, screenHeight, colorBGR);
+  lcd_setArea(0, 0, screenWidth - 1, screenHeight - 1);
+  lcd_fillRun(colorBGR, (u_int)screenWidth * screenHeight);
 }
 
 /** 5x7 font - this function draws background pixels
@@ -78,6 +73,12 @@ void drawChar5x7(u_char rcol, u_char rrow, char c,
  *  FONT_SM_BKG, FONT_MD_BKG, FONT_LG_BKG - as above, but with background color
  *  Adapted from RobG's EduKit
  *
+ *  The whole string, including the 1-pixel gaps between glyphs, is
+ *  written through a single window one raster row at a time.  Pixels
+ *  are coalesced into runs of equal color (runs continue across rows
+ *  since the window wraps).  Columns and rows past the screen edge are
+ *  clipped.
+ *
  *  \param col Column to start drawing string
  *  \param row Row to start drawing string
  *  \param string The string
@@ -87,11 +88,43 @@ void drawChar5x7(u_char rcol, u_char rrow, char c,
 void drawString5x7(u_char col, u_char row, char *string,
 		u_int fgColorBGR, u_int bgColorBGR)
 {
-  u_char cols = col;
-  while (*string) {
-    drawChar5x7(cols, row, *string++, fgColorBGR, bgColorBGR);
-    cols += 6;
+  u_int width = 0, height = 8, runLength = 0;
+  u_int runColor = bgColorBGR;
+  u_char bit;
+  char *s;
+
+  if (col >= screenWidth || row >= screenHeight)
+    return;
+  for (s = string; *s; s++)	/**< 5 columns + 1 gap per glyph */
+    width += 6;
+  if (!width)
+    return;
+  width--;			/**< no gap after the last glyph */
+  if (col + width > screenWidth)
+    width = screenWidth - col;
+  if (row + height > screenHeight)
+    height = screenHeight - row;
+
+  lcd_setArea(col, row, col + width - 1, row + height - 1);
+  for (bit = 0x01; height; height--, bit <<= 1) {
+    u_int x = 0;
+    for (s = string; x < width; s++) {
+      const u_char *glyph = font_5x7[(u_char)(*s - 0x20)];
+      u_char gcol;
+      for (gcol = 0; gcol < 6 && x < width; gcol++, x++) {
+	u_int color = (gcol < 5 && (glyph[gcol] & bit)) ? fgColorBGR : bgColorBGR;
+	if (color != runColor) {
+	  if (runLength)
+	    lcd_fillRun(runColor, runLength);
+	  runColor = color;
+	  runLength = 0;
+	}
+	runLength++;
+      }
+    }
   }
+  if (runLength)
+    lcd_fillRun(runColor, runLength);
 }
 
 
@@ -107,11 +140,15 @@ void drawRectOutline(u_char colMin, u_char rowMin, u_char width, u_char height,
 		     u_int colorBGR)
 {
   /**< top & bot */
-  fillRectangle(colMin, rowMin, width, 1, colorBGR);
-  fillRectangle(colMin, rowMin + height, width, 1, colorBGR);
+  lcd_setArea(colMin, rowMin, colMin + width - 1, rowMin);
+  lcd_fillRun(colorBGR, width);
+  lcd_setArea(colMin, rowMin + height, colMin + width - 1, rowMin + height);
+  lcd_fillRun(colorBGR, width);
 
   /**< left & right */
-  fillRectangle(colMin, rowMin, 1, height, colorBGR);
-  fillRectangle(colMin + width, rowMin, 1, height, colorBGR);
+  lcd_setArea(colMin, rowMin, colMin, rowMin + height - 1);
+  lcd_fillRun(colorBGR, height);
+  lcd_setArea(colMin + width, rowMin, colMin + width, rowMin + height - 1);
+  lcd_fillRun(colorBGR, height);
 }
 
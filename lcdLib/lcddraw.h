@@ -44,6 +44,30 @@ void clearScreen(u_int colorBGR);
 void drawString5x7(u_char col, u_char row, char *string, 
 		   u_int fgColorBGR, u_int bgColorBGR);
 
+/** Draw string at col,row in the 8x12 font, with background
+ *  Glyphs are 8 pixels apart; clipped at the screen edge.
+ *
+ *  \param col Column to start drawing string
+ *  \param row Row to start drawing string
+ *  \param string The string
+ *  \param fgColorBGR Foreground color in BGR
+ *  \param bgColorBGR Background color in BGR
+ */
+void drawString8x12(u_char col, u_char row, char *string,
+		    u_int fgColorBGR, u_int bgColorBGR);
+
+/** Draw string at col,row in the 11x16 font, with background
+ *  Glyphs are 11 pixels apart; clipped at the screen edge.
+ *
+ *  \param col Column to start drawing string
+ *  \param row Row to start drawing string
+ *  \param string The string
+ *  \param fgColorBGR Foreground color in BGR
+ *  \param bgColorBGR Background color in BGR
+ */
+void drawString11x16(u_char col, u_char row, char *string,
+		     u_int fgColorBGR, u_int bgColorBGR);
+
 /** 5x7 font - this function draws background pixels
  *  Adapted from RobG's EduKit
  */
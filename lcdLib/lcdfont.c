@@ -0,0 +1,80 @@
+/** \file lcdfont.c
+ *  \brief String renderers for the 8x12 and 11x16 fonts.
+ *
+ *  Uses row-major tables (font_8x12 as stored, font_11x16_rows as
+ *  generated by makeFonts), so each raster row of a glyph is streamed
+ *  by shifting its bytes left and testing the top bit.  Kept apart from lcddraw.c so programs that only use the 5x7
+ *  font do not link the larger tables.
+ */
+#include "lcdutils.h"
+#include "lcddraw.h"
+
+/** Draw a string from a row-major font through a single window
+ *
+ *  \param glyphs Rows of glyph 0x20; glyph g is at glyphs + g * glyphBytes
+ *  \param glyphWidth Pixels per glyph row (also the advance)
+ *  \param glyphHeight Rows per glyph
+ *  \param rowBytes Bytes per glyph row
+ */
+static void
+drawStringRows(u_char col, u_char row, char *string,
+	       const u_char *glyphs, u_char glyphWidth, u_char glyphHeight,
+	       u_char rowBytes, u_int fgColorBGR, u_int bgColorBGR)
+{
+  u_int glyphBytes = glyphHeight * rowBytes;
+  u_int width = 0, height = glyphHeight, runLength = 0;
+  u_int runColor = bgColorBGR;
+  u_char glyphRow;
+  char *s;
+
+  if (col >= screenWidth || row >= screenHeight)
+    return;
+  for (s = string; *s; s++)
+    width += glyphWidth;
+  if (!width)
+    return;
+  if (col + width > screenWidth)
+    width = screenWidth - col;
+  if (row + height > screenHeight)
+    height = screenHeight - row;
+
+  lcd_setArea(col, row, col + width - 1, row + height - 1);
+  for (glyphRow = 0; glyphRow < height; glyphRow++) {
+    u_int x = 0;
+    for (s = string; x < width; s++) {
+      const u_char *rowp = glyphs + (u_char)(*s - 0x20) * glyphBytes
+	+ glyphRow * rowBytes;
+      u_char bits = *rowp, gcol;
+      for (gcol = 0; gcol < glyphWidth && x < width; gcol++, x++) {
+	u_int color;
+	if (gcol && !(gcol & 7))
+	  bits = *++rowp;	/**< next byte of a wide row */
+	color = (bits & 0x80) ? fgColorBGR : bgColorBGR;
+	bits <<= 1;
+	if (color != runColor) {
+	  if (runLength)
+	    lcd_fillRun(runColor, runLength);
+	  runColor = color;
+	  runLength = 0;
+	}
+	runLength++;
+      }
+    }
+  }
+  if (runLength)
+    lcd_fillRun(runColor, runLength);
+}
+
+void drawString8x12(u_char col, u_char row, char *string,
+		    u_int fgColorBGR, u_int bgColorBGR)
+{
+  drawStringRows(col, row, string, &font_8x12[0][0], 8, 12, 1,
+		 fgColorBGR, bgColorBGR);
+}
+
+void drawString11x16(u_char col, u_char row, char *string,
+		     u_int fgColorBGR, u_int bgColorBGR)
+{
+  drawStringRows(col, row, string, &font_11x16_rows[0][0][0], 11, 16, 2,
+		 fgColorBGR, bgColorBGR);
+}
@@ -0,0 +1,69 @@
+/** \file lcdsprite.c
+ *  \brief Palette-indexed sprites stored at 1, 2 or 4 bits per pixel.
+ *
+ *  Rows are decoded by shifting the packed bytes left bpp bits at a
+ *  time, so each pixel costs a shift and one palette lookup.  Colors
+ *  are gathered into a short buffer and sent with lcd_pushPixels.
+ */
+#include "lcdutils.h"
+#include "lcdsprite.h"
+
+#define CHUNK 8			/**< colors gathered per lcd_pushPixels */
+
+void drawSprite(int col, int row, const Sprite *sprite)
+{
+  u_char bpp = sprite->bpp, perByte = 8 / bpp, shift = 8 - bpp;
+  u_char opaque = sprite->maskIndex >= (1 << bpp);
+  u_char rowBytes = spriteRowBytes(sprite->width, bpp);
+  const u_int *palette = sprite->palette;
+  int x0 = 0, x1 = sprite->width, y0 = 0, y1 = sprite->height, y;
+  u_int colors[CHUNK];
+
+  if (col < 0)			/**< clip to the screen */
+    x0 = -col;
+  if (row < 0)
+    y0 = -row;
+  if (col + x1 > screenWidth)
+    x1 = screenWidth - col;
+  if (row + y1 > screenHeight)
+    y1 = screenHeight - row;
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  if (opaque)
+    lcd_setArea(col + x0, row + y0, col + x1 - 1, row + y1 - 1);
+  for (y = y0; y < y1; y++) {
+    const u_char *p = sprite->pixels + y * rowBytes + x0 / perByte;
+    u_char skip = x0 % perByte;
+    u_char bits = *p++ << (skip * bpp), left = perByte - skip;
+    u_char n = 0, inSpan = opaque;
+    int x;
+    for (x = x0; x < x1; x++) {
+      u_char index;
+      if (!left) {
+	bits = *p++;
+	left = perByte;
+      }
+      index = bits >> shift;
+      bits <<= bpp;
+      left--;
+      if (!opaque && index == sprite->maskIndex) {
+	if (n)
+	  lcd_pushPixels(colors, n);
+	n = inSpan = 0;
+	continue;
+      }
+      if (!inSpan) {		/**< window runs to the row's end; */
+	lcd_setArea(col + x, row + y, col + x1 - 1, row + y); /* the span may stop early */
+	inSpan = 1;
+      }
+      colors[n++] = palette[index];
+      if (n == CHUNK) {
+	lcd_pushPixels(colors, n);
+	n = 0;
+      }
+    }
+    if (n)
+      lcd_pushPixels(colors, n);
+  }
+}
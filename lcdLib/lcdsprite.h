@@ -0,0 +1,42 @@
+/** \file lcdsprite.h
+ *  \brief Palette-indexed sprites stored at 1, 2 or 4 bits per pixel.
+ */
+
+#ifndef lcdsprite_included
+#define lcdsprite_included
+
+#include "lcdutils.h"
+
+/** maskIndex value for sprites without transparent pixels */
+#define SPRITE_OPAQUE 0xff
+
+/** A sprite, normally const so that it stays in flash
+ *
+ *  pixels holds height rows of palette indices, leftmost pixel in the
+ *  most significant bits, each row padded to a whole byte.
+ */
+typedef struct {
+  u_char width, height;
+  u_char bpp;			/**< bits per pixel: 1, 2 or 4 */
+  u_char maskIndex;		/**< palette index not drawn, or SPRITE_OPAQUE */
+  const u_int *palette;		/**< 1 << bpp colors in BGR */
+  const u_char *pixels;
+} Sprite;
+
+/** Bytes per row of a sprite's pixel data */
+#define spriteRowBytes(width, bpp) (((width) * (bpp) + 7) / 8)
+
+/** Draw sprite with its top-left corner at col,row
+ *
+ *  Indices are expanded through the palette as they are sent.  Pixels
+ *  with maskIndex are skipped, leaving whatever is on screen.  The
+ *  sprite may hang off any screen edge; position is signed so it can
+ *  enter from the left or top.
+ *
+ *  \param col Column of the left edge
+ *  \param row Row of the top edge
+ *  \param sprite The sprite
+ */
+void drawSprite(int col, int row, const Sprite *sprite);
+
+#endif // lcdsprite_included
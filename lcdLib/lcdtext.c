@@ -0,0 +1,86 @@
+/** \file lcdtext.c
+ *  \brief Retained 5x7 text fields that redraw only changed glyphs.
+ */
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "lcdtext.h"
+
+#define GLYPH_ADVANCE 6		/**< 5 columns + 1 gap */
+#define GLYPH_HEIGHT 8
+
+void textFieldInit(TextField *field, u_char col, u_char row,
+		   u_int fgColorBGR, u_int bgColorBGR)
+{
+  field->col = col;
+  field->row = row;
+  field->fgColorBGR = fgColorBGR;
+  field->bgColorBGR = bgColorBGR;
+  textFieldInvalidate(field);
+}
+
+void textFieldInvalidate(TextField *field)
+{
+  field->drawn = 0;
+  field->text[0] = 0;
+}
+
+void textFieldSet(TextField *field, const char *string)
+{
+  char *old = field->text;
+  u_char newLen = 0, oldLen = 0, i = 0;
+
+  while (newLen < TEXTFIELD_MAX && string[newLen])
+    newLen++;
+  while (old[oldLen])
+    oldLen++;
+
+  while (i < newLen) {
+    char run[TEXTFIELD_MAX + 1];
+    u_char start, n = 0;
+    if (field->drawn && i < oldLen && string[i] == old[i]) {
+      i++;			/**< glyph already on screen */
+      continue;
+    }
+    for (start = i; i < newLen; i++) { /**< one window for adjacent changes */
+      if (field->drawn && i < oldLen && string[i] == old[i])
+	break;
+      run[n++] = string[i];
+    }
+    run[n] = 0;
+    drawString5x7(field->col + start * GLYPH_ADVANCE, field->row, run,
+		  field->fgColorBGR, field->bgColorBGR);
+  }
+  if (field->drawn && oldLen > newLen) /**< clear cells no longer used */
+    fillRectangle(field->col + newLen * GLYPH_ADVANCE, field->row,
+		  (oldLen - newLen) * GLYPH_ADVANCE - 1, GLYPH_HEIGHT,
+		  field->bgColorBGR);
+
+  for (i = 0; i < newLen; i++)
+    old[i] = string[i];
+  old[newLen] = 0;
+  field->drawn = 1;
+}
+
+u_char textFormatUInt(char *buf, u_int value)
+{
+  static const u_int powers[] = {10000, 1000, 100, 10, 1};
+  u_char i, n = 0;
+  for (i = 0; i < 5; i++) {
+    char digit = '0';
+    while (value >= powers[i]) { /**< no hardware divide: subtract */
+      value -= powers[i];
+      digit++;
+    }
+    if (n || digit != '0' || i == 4)
+      buf[n++] = digit;
+  }
+  buf[n] = 0;
+  return n;
+}
+
+void textFieldSetUInt(TextField *field, u_int value)
+{
+  char buf[6];
+  textFormatUInt(buf, value);
+  textFieldSet(field, buf);
+}
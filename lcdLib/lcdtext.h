@@ -0,0 +1,63 @@
+/** \file lcdtext.h
+ *  \brief Retained 5x7 text fields that redraw only changed glyphs.
+ */
+
+#ifndef lcdtext_included
+#define lcdtext_included
+
+#include "lcdutils.h"
+
+/** Longest string a TextField holds */
+#ifndef TEXTFIELD_MAX
+#define TEXTFIELD_MAX 8
+#endif
+
+/** A string at a fixed position, remembered as last drawn
+ *
+ *  Updating a field compares the new string with text[] and only sends
+ *  the glyph cells that differ, so an unchanged field costs nothing on
+ *  the bus.
+ */
+typedef struct {
+  u_char col, row;		/**< top-left of the first glyph */
+  u_int fgColorBGR, bgColorBGR;
+  u_char drawn;			/**< 0: nothing on screen yet */
+  char text[TEXTFIELD_MAX + 1];	/**< what is on screen now */
+} TextField;
+
+/** Set a field's position and colors; nothing is drawn until it is set
+ *
+ *  \param field The field
+ *  \param col Column of the first glyph
+ *  \param row Row of the first glyph
+ *  \param fgColorBGR Foreground color in BGR
+ *  \param bgColorBGR Background color in BGR
+ */
+void textFieldInit(TextField *field, u_char col, u_char row,
+		   u_int fgColorBGR, u_int bgColorBGR);
+
+/** Show string in the field, redrawing only glyph cells that changed
+ *
+ *  Cells left over from a longer previous string are cleared to the
+ *  background color.  Strings longer than TEXTFIELD_MAX are truncated.
+ */
+void textFieldSet(TextField *field, const char *string);
+
+/** Show an unsigned number in decimal (see textFormatUInt) */
+void textFieldSetUInt(TextField *field, u_int value);
+
+/** Forget what is on screen so the next update redraws the whole field
+ *
+ *  Use after something else has drawn over the field.
+ */
+void textFieldInvalidate(TextField *field);
+
+/** Format value in decimal without the C library
+ *
+ *  \param buf (out) At least 6 chars; NUL terminated
+ *  \param value The value
+ *  \return Number of digits written
+ */
+u_char textFormatUInt(char *buf, u_int value);
+
+#endif // lcdtext_included
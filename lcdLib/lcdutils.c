@@ -9,10 +9,13 @@
  */
  
 #include "lcdutils.h"
-#include "msp430.h"
+#include "txqueue.h"
 
 u_char _orientation = 0;
 
+#ifndef LCD_EMULATOR
+#include "msp430.h"
+
 /** LCD pin definitions*/
 /** SCLK & MOSI*/
 #define LCD_SPI_OUT		P1OUT
@@ -40,6 +43,31 @@ u_char _orientation = 0;
 #define LCD_DC_LO() LCD_DC_OUT &= ~LCD_DC_PIN
 #define LCD_DC_HI() LCD_DC_OUT |= LCD_DC_PIN
 
+/** SPI bus primitives */
+#define _spiWaitIdle()   while (UCB0STAT & UCBUSY) /**< last byte shifted out */
+#define _spiWaitTxBuf()  while (!(IFG2 & UCB0TXIFG)) /**< room in TXBUF */
+#define _spiTxBufFree()  (IFG2 & UCB0TXIFG)
+#define _spiSend(b)      (UCB0TXBUF = (b))
+#define _txIrqArm()      (IE2 |= UCB0TXIE)
+#define _txIrqDisarm()   (IE2 &= ~UCB0TXIE)
+
+#else  /* LCD_EMULATOR: host build, bytes go to the emulated controller */
+#include "st7735emu.h"
+
+#define LCD_DC_LO()      ((void)0)
+#define LCD_DC_HI()      ((void)0)
+#define _spiWaitIdle()
+#define _spiWaitTxBuf()
+#define _spiTxBufFree()  1
+#define _spiSend(b)      st7735_receive((b), _dcIsCommand)
+#define _txIrqArm()      _txDrain() /**< no interrupts: drain at once */
+#define _txIrqDisarm()
+#define __get_interrupt_state() 0
+#define __disable_interrupt()
+#define __set_interrupt_state(state) ((void)(state))
+#define __delay_cycles(cycles)
+#endif /* LCD_EMULATOR */
+
 /** LCD driver IC specific defines */
 #define SWRESET							0x01
 #define	SLEEPOUT						0x11
@@ -47,13 +75,16 @@ u_char _orientation = 0;
 #define CASETP							0x2A
 #define PASETP							0x2B
 #define RAMWRP							0x2C
+#define VSCRDEF							0x33
 #define	MADCTL							0x36
+#define VSCSAD							0x37
 #define	COLMOD							0x3A
 #define GMCTRP1							0xE0
 #define GMCTRN1							0xE1
 
 /** Set up onboard LCD's SPI and control pins */
 static void setUpSPIforLCD() {
+#ifndef LCD_EMULATOR
   LCD_DC_OUT |= LCD_DC_PIN;
   LCD_DC_DIR |= LCD_DC_PIN;
   
@@ -74,19 +105,224 @@ static void setUpSPIforLCD() {
   UCB0BR1 = 0;
   UCB0CTL1 &= ~UCSWRST;
   LCD_SELECT();
+#endif
 }
 
 /** Screen dimensions */
 
+/** Transmit queue, drained by the USCI_B0 TX interrupt when enabled */
+static TxQueue _txQueue;
+static u_char _txQueueOn = 0;
+static u_char _dcIsCommand = 0;	/**< last level driven onto D/C */
+
+/** Pixels of lcd_pushPixelsAsync still to send, ahead of the queue */
+static const u_int *volatile _asyncNext;
+static volatile u_int _asyncBytes = 0; /**< odd: low byte of *_asyncNext next */
+
+/** Drive D/C for the next byte (private)
+ *  D/C may only change once the previous byte has fully shifted out.
+ */
+static inline void
+_setDC(u_char isCommand)
+{
+  _spiWaitIdle();		/**< wait for previous transfer to complete */
+  if (isCommand)
+    LCD_DC_LO();
+  else
+    LCD_DC_HI();
+  _dcIsCommand = isCommand;
+}
+
+/** Send the oldest queued byte, disarm the interrupt when empty (private)
+ *  Call only when UCB0TXBUF is free.
+ */
+static void
+_txSendNext()
+{
+  if (_asyncBytes) {		/**< async pixels go first */
+    u_int color = *_asyncNext;
+    if (_asyncBytes-- & 1) {
+      _spiSend(color);
+      _asyncNext++;
+    } else
+      _spiSend(color >> 8);
+    return;
+  }
+  int entry = txQueueGet(&_txQueue);
+  if (entry < 0) {
+    _txIrqDisarm();		/**< nothing left: stop interrupting */
+    return;
+  }
+  u_char isCommand = entry >> 8;
+  if (isCommand != _dcIsCommand)
+    _setDC(isCommand);
+  _spiSend(entry);
+}
+
+/** Move one byte from the queue to the bus from the foreground (private)
+ *  Used when the queue is full or being flushed; interrupts are masked
+ *  so this cannot race the TX handler, and it makes progress even when
+ *  GIE is off.
+ */
+static void
+_txService()
+{
+  u_int state = __get_interrupt_state();
+  __disable_interrupt();
+  if (_spiTxBufFree())
+    _txSendNext();
+  __set_interrupt_state(state);
+}
+
+static void _txDrain();
+
+/** Wait until the async pixels have been handed to the bus (private) */
+#define _asyncWait() do {			\
+    while (_asyncBytes)				\
+      _txService();				\
+  } while (0)
+
+/** Queue a byte and arm the TX interrupt (private) */
+static void
+_txPut(u_char byte, u_char isCommand)
+{
+  while (!txQueuePut(&_txQueue, byte, isCommand))
+    _txService();		/**< full: help drain */
+  _txIrqArm();			/**< TXIFG is set while idle, so this fires at once */
+}
+
+#ifndef LCD_EMULATOR
+/** USCI_B0 transmit interrupt: feed the next queued byte */
+void
+__interrupt_vec(USCIAB0TX_VECTOR) _lcdTxISR()
+{
+  if ((IE2 & UCB0TXIE) && (IFG2 & UCB0TXIFG))
+    _txSendNext();
+}
+#endif
+
+/** Wait for the queue and the bus to empty (private) */
+static void
+_txDrain()
+{
+  _asyncWait();
+  while (!txQueueEmpty(&_txQueue))
+    _txService();
+  _spiWaitIdle();		/**< last byte off the wire */
+}
+
+void lcd_setTxQueue(u_char enable)
+{
+  if (!enable)
+    _txDrain();
+  else if (!_txQueueOn)
+    txQueueInit(&_txQueue);
+  _txQueueOn = enable;
+}
+
+/** Address window cache
+ *  The controller keeps its CASET/PASET window until told otherwise,
+ *  and RAMWR restarts writing at the window's top-left.  Track both so
+ *  lcd_setArea only sends what changed.  _winWritten counts pixels sent
+ *  since RAMWR modulo the window area: the write pointer wraps to the
+ *  window start after the last pixel, so zero means it is back there.
+ */
+static u_char _winValid = 0;	/**< window registers known */
+static u_char _winColStart, _winColEnd, _winRowStart, _winRowEnd;
+static u_char _ramWriteOpen = 0; /**< no command since the last RAMWR */
+static u_int _winArea = 1, _winWritten = 0;
+
+#ifdef LCD_WINDOW_STATS
+LcdWindowStats lcd_windowStats;
+#endif
+
+/** Account for count pixels written into the window (private) */
+static void
+_winAdvance(u_int count)
+{
+  if (count >= _winArea)
+    count %= _winArea;
+  _winWritten += count;
+  if (_winWritten >= _winArea)
+    _winWritten -= _winArea;
+}
+
+void lcd_invalidateArea()
+{
+  _winValid = 0;
+  _ramWriteOpen = 0;
+}
+
+#ifdef LCD_WINDOW_STATS
+void lcd_resetWindowStats()
+{
+  lcd_windowStats.cmdBytesSent = 0;
+  lcd_windowStats.cmdBytesSaved = 0;
+}
+#endif
+
 /** Write data to LCD */
 static inline void 
 lcd_writeData(u_char data) 
 {
-  while (UCB0STAT & UCBUSY);	/**< wait for previous transfer to complete */
-  LCD_DC_HI();			/**< specify sending data */
-  UCB0TXBUF = data;		/**< send data */
+  if (_txQueueOn) {
+    _txPut(data, 0);
+    return;
+  }
+  _asyncWait();
+  _setDC(0);			/**< specify sending data */
+  _spiSend(data);		/**< send data */
+}
+
+#if LCD_COLOR_BITS == 12
+/** 12 bit pixels go out in pairs, BBBBGGGG RRRRbbbb ggggrrrr.  A pixel
+ *  without a partner yet waits here (private).
+ */
+static u_char _pixelPending = 0;
+static u_int _pixelPendingColor;
+
+/** Send a waiting odd pixel on its own (private)
+ *  Its two bytes leave the controller half way into the next pixel, so
+ *  the write must be restarted by RAMWR before more pixels follow.
+ */
+static void
+_pixelFlush()
+{
+  if (!_pixelPending)
+    return;
+  _pixelPending = 0;
+  lcd_writeData(_pixelPendingColor >> 4);
+  lcd_writeData(_pixelPendingColor << 4);
+  _ramWriteOpen = 0;
 }
 
+/** Send a waiting pixel that ends the window (private)
+ *  Nothing will pair with it, and the display should not wait for the
+ *  next command to show it.
+ */
+#define _pixelFlushAtEnd() do {			\
+    if (_pixelPending && !_winWritten)		\
+      _pixelFlush();				\
+  } while (0)
+
+void lcd_writeColor(u_int colorBGR)
+{
+  if (_pixelPending) {
+    lcd_writeData(_pixelPendingColor >> 4);
+    lcd_writeData((_pixelPendingColor << 4) | ((colorBGR >> 8) & 0x0f));
+    lcd_writeData(colorBGR);
+    _pixelPending = 0;
+  } else {
+    _pixelPendingColor = colorBGR;
+    _pixelPending = 1;
+  }
+  if (++_winWritten >= _winArea)
+    _winWritten = 0;
+  _pixelFlushAtEnd();
+}
+#else
+#define _pixelFlush()
+
 typedef union {
   u_char colorBytes[2];
   u_int colorBGRWord;
@@ -97,50 +333,243 @@ void lcd_writeColor(u_int colorBGR)
   ColorBGR colorU = {.colorBGRWord = colorBGR};
   lcd_writeData(colorU.colorBytes[1]);
   lcd_writeData(colorU.colorBytes[0]);
+  if (++_winWritten >= _winArea)
+    _winWritten = 0;
+}
+#endif
+
+void lcd_flush()
+{
+  _pixelFlush();
+  _txDrain();
+}
+
+/** Put one data byte once UCB0TXBUF has room (private)
+ *  Polling TXIFG instead of UCBUSY keeps the next byte staged while
+ *  the current one shifts out.
+ */
+#define _burstByte(b) do {			\
+    _spiWaitTxBuf();				\
+    _spiSend(b);				\
+  } while (0)
+
+/** Prepare for a polled burst of pixel data (private) */
+static inline void
+_burstBegin()
+{
+  if (_txQueueOn)
+    _txDrain();			/**< queued bytes must go first */
+  else
+    _asyncWait();
+  if (_dcIsCommand)
+    _setDC(0);
+}
+
+#if LCD_COLOR_BITS == 12
+/** Send two 12 bit pixels as three bytes (private) */
+#define _burstPair(c0, c1) do {				\
+    _burstByte((c0) >> 4);				\
+    _burstByte(((c0) << 4) | (((c1) >> 8) & 0x0f));	\
+    _burstByte(c1);					\
+  } while (0)
+
+void lcd_fillRun(u_int colorBGR, u_int count)
+{
+  u_char b0 = colorBGR >> 4, b1 = (colorBGR << 4) | ((colorBGR >> 8) & 0x0f);
+  u_char b2 = colorBGR;
+  _burstBegin();
+  _winAdvance(count);
+  if (_pixelPending && count) {	/**< complete the waiting pair */
+    _burstPair(_pixelPendingColor, colorBGR);
+    _pixelPending = 0;
+    count--;
+  }
+  for (; count >= 4; count -= 4) {
+    _burstByte(b0); _burstByte(b1); _burstByte(b2);
+    _burstByte(b0); _burstByte(b1); _burstByte(b2);
+  }
+  for (; count >= 2; count -= 2) {
+    _burstByte(b0); _burstByte(b1); _burstByte(b2);
+  }
+  if (count) {
+    _pixelPendingColor = colorBGR;
+    _pixelPending = 1;
+    _pixelFlushAtEnd();
+  }
+}
+
+void lcd_pushPixels(const u_int *colorsBGR, u_int count)
+{
+  u_int c0, c1;
+  _burstBegin();
+  _winAdvance(count);
+  if (_pixelPending && count) {
+    c1 = *colorsBGR++;
+    _burstPair(_pixelPendingColor, c1);
+    _pixelPending = 0;
+    count--;
+  }
+  for (; count >= 2; count -= 2) {
+    c0 = *colorsBGR++; c1 = *colorsBGR++;
+    _burstPair(c0, c1);
+  }
+  if (count) {
+    _pixelPendingColor = *colorsBGR;
+    _pixelPending = 1;
+    _pixelFlushAtEnd();
+  }
 }
 
+/** Pairs straddle buffers, so 12 bit pixels are sent at once */
+void lcd_pushPixelsAsync(const u_int *colorsBGR, u_int count)
+{
+  lcd_pushPixels(colorsBGR, count);
+}
+#else
+void lcd_fillRun(u_int colorBGR, u_int count)
+{
+  u_char hi = colorBGR >> 8, lo = colorBGR;
+  _burstBegin();
+  _winAdvance(count);
+  for (; count >= 4; count -= 4) {
+    _burstByte(hi); _burstByte(lo);
+    _burstByte(hi); _burstByte(lo);
+    _burstByte(hi); _burstByte(lo);
+    _burstByte(hi); _burstByte(lo);
+  }
+  while (count--) {
+    _burstByte(hi); _burstByte(lo);
+  }
+}
+
+void lcd_pushPixels(const u_int *colorsBGR, u_int count)
+{
+  u_int c;
+  _burstBegin();
+  _winAdvance(count);
+  for (; count >= 4; count -= 4) {
+    c = *colorsBGR++; _burstByte(c >> 8); _burstByte(c);
+    c = *colorsBGR++; _burstByte(c >> 8); _burstByte(c);
+    c = *colorsBGR++; _burstByte(c >> 8); _burstByte(c);
+    c = *colorsBGR++; _burstByte(c >> 8); _burstByte(c);
+  }
+  while (count--) {
+    c = *colorsBGR++; _burstByte(c >> 8); _burstByte(c);
+  }
+}
+
+void lcd_pushPixelsAsync(const u_int *colorsBGR, u_int count)
+{
+  _burstBegin();		/**< previous pixels and queued bytes are out */
+  _winAdvance(count);
+  if (!count)
+    return;
+  _asyncNext = colorsBGR;
+  _asyncBytes = count << 1;
+  _txIrqArm();			/**< TXIFG is set, so the first byte goes at once */
+}
+#endif
+
 /** Write command to LCD (private) */
 void _writeCommand(u_char command) 
 {
-  while (UCB0STAT & UCBUSY);	/**< wait for previous transfer to complete */
-  LCD_DC_LO();			          /**< specify sending a command */
-  UCB0TXBUF = command;		    /**< send command */
+  _pixelFlush();		/**< a command ends the pixel stream */
+  _ramWriteOpen = (command == RAMWRP);
+  if (_txQueueOn) {
+    _txPut(command, 1);
+    return;
+  }
+  _asyncWait();
+  _setDC(1);			/**< specify sending a command */
+  _spiSend(command);		/**< send command */
 }
 
 /** Long delay (private) */
 void _delay(u_char x10ms) {
+	_txDrain();		/**< delays are relative to the bus going idle */
 	while (x10ms > 0) {
 		__delay_cycles(160000);
 		x10ms--;
 	}
 }
 
-/** Set area to draw to */
+/** Set area to draw to
+ *  Only the parts of CASET/PASET/RAMWR that change are sent.
+ */
 void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd) 
 {
-	_writeCommand(CASETP);
-	lcd_writeData(0);
-	lcd_writeData(colStart);
-	lcd_writeData(0);
-	lcd_writeData(colEnd);
-	_writeCommand(PASETP);
-	lcd_writeData(0);
-	lcd_writeData(rowStart);
-	lcd_writeData(0);
-	lcd_writeData(rowEnd);
-	_writeCommand(RAMWRP);
+	u_char sent = 0, changed = 0;
+	if (!_winValid || colStart != _winColStart || colEnd != _winColEnd) {
+		_writeCommand(CASETP);
+		lcd_writeData(0);
+		lcd_writeData(colStart);
+		lcd_writeData(0);
+		lcd_writeData(colEnd);
+		_winColStart = colStart;
+		_winColEnd = colEnd;
+		sent += 5;
+		changed = 1;
+	}
+	if (!_winValid || rowStart != _winRowStart || rowEnd != _winRowEnd) {
+		_writeCommand(PASETP);
+		lcd_writeData(0);
+		lcd_writeData(rowStart);
+		lcd_writeData(0);
+		lcd_writeData(rowEnd);
+		_winRowStart = rowStart;
+		_winRowEnd = rowEnd;
+		sent += 5;
+		changed = 1;
+	}
+	if (changed) {
+		_winValid = 1;
+		_winArea = (u_int)(u_char)(colEnd - colStart + 1) * (u_char)(rowEnd - rowStart + 1);
+	}
+	if (!_ramWriteOpen || _winWritten) { /**< pointer not at window start */
+		_writeCommand(RAMWRP);
+		sent += 1;
+	}
+	_winWritten = 0;
+#ifdef LCD_WINDOW_STATS
+	lcd_windowStats.cmdBytesSent += sent;
+	lcd_windowStats.cmdBytesSaved += 11 - sent;
+#endif
+}
+
+void lcd_setScrollArea(u_char topFixed, u_char scrollLines)
+{
+  _writeCommand(VSCRDEF);
+  lcd_writeData(0);
+  lcd_writeData(topFixed);
+  lcd_writeData(0);
+  lcd_writeData(scrollLines);
+  lcd_writeData(0);
+  lcd_writeData(LONG_EDGE_PIXELS - topFixed - scrollLines);
+}
+
+void lcd_setScrollStart(u_char line)
+{
+  _writeCommand(VSCSAD);
+  lcd_writeData(0);
+  lcd_writeData(line);
 }
 
 /** Initialize onboard LCD */
 void lcd_init() 
 {
   setUpSPIforLCD();
+  lcd_invalidateArea();
   _writeCommand(SWRESET);  /**< software reset */
   _delay(20);
   _writeCommand(SLEEPOUT); /**< exit sleep */
   _delay(20);
+#if LCD_COLOR_BITS == 12
+  _writeCommand(COLMOD);   /**< Set Color Format 12bit */
+  lcd_writeData(0x03);
+#else
   _writeCommand(COLMOD);   /**< Set Color Format 16bit */
   lcd_writeData(0x05);
+#endif
   _writeCommand(DISPON);   /**< display ON */
 
   _writeCommand(MADCTL);
@@ -14,6 +14,11 @@ extern const unsigned char font_5x7[96][5];
 extern const unsigned char font_8x12[95][12];
 extern const unsigned int font_11x16[95][11];
 
+/** Row-major copy of font_11x16 generated by makeFonts: one bit per
+ *  pixel, leftmost pixel in the top bit of each row's first byte
+ *  (font_8x12 is already stored that way) */
+extern const unsigned char font_11x16_rows[95][16][2];
+
 extern const unsigned int colors[43];
 
 
@@ -38,6 +43,26 @@ extern const unsigned int colors[43];
 # define screenWidth LONG_EDGE_PIXELS
 #endif
 
+/** Pixel format on the bus
+ *
+ *  16: BGR 5-6-5, two bytes per pixel (the default).
+ *  12: BGR 4-4-4, two pixels in three bytes, 25% less traffic.
+ *  Select with -DLCD_COLOR_BITS=12 when compiling lcdLib and every
+ *  program that uses its color constants.
+ */
+#ifndef LCD_COLOR_BITS
+#define LCD_COLOR_BITS 16
+#endif
+
+#if LCD_COLOR_BITS == 12
+/** Convert a BGR 5-6-5 constant to the bus format, at compile time */
+# define LCD_COLOR(bgr565) ((((bgr565) >> 4) & 0xf00) | (((bgr565) >> 3) & 0x0f0) | (((bgr565) >> 1) & 0x00f))
+#elif LCD_COLOR_BITS == 16
+# define LCD_COLOR(bgr565) (bgr565)
+#else
+# error LCD_COLOR_BITS must be 12 or 16
+#endif
+
 /** Initialize the onboard LCD */
 void lcd_init();
 
@@ -50,60 +75,156 @@ void lcd_init();
  */
 void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd);
 
+/** Forget the cached address window
+ *
+ *  lcd_setArea skips CASET/PASET/RAMWR bytes that would not change the
+ *  controller's state.  Call this after writing to the controller
+ *  other than through lcdutils so the next lcd_setArea sends everything.
+ */
+void lcd_invalidateArea();
+
+#ifdef LCD_WINDOW_STATS	/* profiling builds only (the host build defines it) */
+/** Window setup traffic, accumulated across lcd_setArea calls */
+typedef struct {
+  u_int cmdBytesSent;		/**< CASET/PASET/RAMWR bytes sent */
+  u_int cmdBytesSaved;		/**< bytes the window cache elided */
+} LcdWindowStats;
+
+extern LcdWindowStats lcd_windowStats;
+
+/** Zero lcd_windowStats, e.g. at the start of each frame */
+void lcd_resetWindowStats();
+#endif
+
+/** Divide the 160 pixel edge into a fixed top area, a scrolling area
+ *  and a fixed bottom area (VSCRDEF)
+ *
+ *  Scrolling moves frame-memory lines along the long edge: rows in the
+ *  vertical orientations, columns in the horizontal ones.
+ *
+ *  \param topFixed Lines fixed above the scrolling area
+ *  \param scrollLines Lines that scroll; the remainder are fixed below
+ */
+void lcd_setScrollArea(u_char topFixed, u_char scrollLines);
+
+/** Show frame-memory line at the top of the scrolling area (VSCSAD)
+ *
+ *  The lines after it follow, wrapping from the end of the scrolling
+ *  area back to its start.  Nothing is redrawn, so scrolling by n
+ *  lines costs three bytes plus drawing the n lines that come into
+ *  view.
+ *
+ *  \param line Between topFixed and topFixed + scrollLines - 1
+ */
+void lcd_setScrollStart(u_char line);
+
 /** Write color to LCD
  *
- *  \param colorBGR The color in BGR
+ *  In 12 bit mode pixels are sent in pairs, so an odd pixel waits for
+ *  the next one (or the next command, or lcd_flush) before it is sent;
+ *  the last pixel of a window goes out at once.
+ *
+ *  \param colorBGR The color in BGR, in the LCD_COLOR_BITS format
  */
 void lcd_writeColor(u_int colorBGR);
 
-#define rgb2bgr(val) ((((val) << 11)&0xf800) | ((val)&0x7e0) | (((val)>>11)&0x1f))
+/** Write the same color count times, as fast as the bus allows
+ *
+ *  \param colorBGR The color in BGR
+ *  \param count Number of pixels
+ */
+void lcd_fillRun(u_int colorBGR, u_int count);
+
+/** Write count colors from a buffer, as fast as the bus allows
+ *
+ *  \param colorsBGR The colors in BGR
+ *  \param count Number of pixels
+ */
+void lcd_pushPixels(const u_int *colorsBGR, u_int count);
+
+/** Start sending count colors from a buffer under the TX interrupt
+ *  and return at once
+ *
+ *  It first waits for the previous lcd_pushPixelsAsync to finish, so a
+ *  program can fill one buffer while another is sent.  Leave colorsBGR
+ *  untouched until the next lcd_pushPixelsAsync or lcd_flush returns.
+ *  Other LCD output waits for the pixels (or, through the transmit
+ *  queue, follows them).  Requires GIE for overlap; with interrupts off
+ *  the pixels are sent by whichever call waits for them.  In 12 bit
+ *  mode this is lcd_pushPixels.
+ *
+ *  \param colorsBGR The colors in BGR
+ *  \param count Number of pixels
+ */
+void lcd_pushPixelsAsync(const u_int *colorsBGR, u_int count);
+
+/** Route LCD output through the interrupt-driven transmit queue
+ *
+ *  When enabled, command and data bytes are queued and sent by the
+ *  USCI_B0 TX interrupt so the CPU can keep computing while the bus
+ *  drains.  Requires GIE for overlap; with interrupts off the queue
+ *  is drained from the foreground when it fills.
+ *
+ *  \param enable Nonzero to queue, zero to flush and return to polling
+ */
+void lcd_setTxQueue(u_char enable);
+
+/** Barrier: wait until every queued byte has left the SPI bus
+ *
+ *  Call before touching the LCD's pins or USCI directly.  In 12 bit
+ *  mode this also sends a pixel still waiting for its pair; drawing
+ *  must then resume with lcd_setArea.
+ */
+void lcd_flush();
+
+#define rgb2bgr(val) LCD_COLOR((((val) << 11)&0xf800) | ((val)&0x7e0) | (((val)>>11)&0x1f))
 
-/** Colors */
-#define BLACK 0x0000
-#define WHITE 0xFFFF
+/** Colors, BGR 5-6-5 converted to the bus format */
+#define BLACK LCD_COLOR(0x0000)
+#define WHITE LCD_COLOR(0xFFFF)
 #define COLOR_BLACK   BLACK
 #define COLOR_WHITE   WHITE
 
-#define COLOR_BLUE              0xf800
-#define COLOR_RED 		0x001f
-#define COLOR_GREEN   		0x07e0
-#define COLOR_CYAN    		0xffe0
-#define COLOR_MAGENTA 		0xf81f
-#define COLOR_YELLOW  		0x07ff
-#define COLOR_ORANGE		0x053f
-#define COLOR_ORANGE_RED	0x023f
-#define COLOR_DARK_ORANGE	0x047f
-#define COLOR_GRAY		0xbdf7
-#define COLOR_NAVY		0x8000
-#define COLOR_ROYAL_BLUE	0xe348
-#define COLOR_SKY_BLUE		0xee70
-#define COLOR_TURQUOISE		0xd708
-#define COLOR_STEEL_BLUE	0xb408
-#define COLOR_LIGHT_BLUE	0xe6d5
-#define COLOR_AQUAMARINE	0xd7ef
-#define COLOR_DARK_GREEN	0x0320
-#define COLOR_DARK_OLIVE_GREEN	0x2b4a
-#define COLOR_SEA_GREEN		0x5445
-#define COLOR_SPRING_GREEN	0x7fe0
-#define COLOR_PALE_GREEN	0x9fd3
-#define COLOR_GREEN_YELLOW	0x2ff5
-#define COLOR_LIME_GREEN	0x3666
-#define COLOR_FOREST_GREEN	0x2444
-#define COLOR_KHAKI		0x8f3e
-#define COLOR_GOLD		0x06bf
-#define COLOR_GOLDENROD		0x253b
-#define COLOR_SIENNA		0x2a94
-#define COLOR_BEIGE		0xdfbe
-#define COLOR_TAN		0x8dba
-#define COLOR_BROWN		0x2954
-#define COLOR_CHOCOLATE		0x1b5a
-#define COLOR_FIREBRICK		0x2116
-#define COLOR_HOT_PINK		0xb35f
-#define COLOR_PINK		0xce1f
-#define COLOR_DEEP		0x90bf
-#define COLOR_VIOLET		0xec1d
-#define COLOR_DARK_VIOLE	0xd012
-#define COLOR_PURPLE		0xf114
-#define COLOR_MEDIUM_PURPLE	0xdb92
+#define COLOR_BLUE              LCD_COLOR(0xf800)
+#define COLOR_RED 		LCD_COLOR(0x001f)
+#define COLOR_GREEN   		LCD_COLOR(0x07e0)
+#define COLOR_CYAN    		LCD_COLOR(0xffe0)
+#define COLOR_MAGENTA 		LCD_COLOR(0xf81f)
+#define COLOR_YELLOW  		LCD_COLOR(0x07ff)
+#define COLOR_ORANGE		LCD_COLOR(0x053f)
+#define COLOR_ORANGE_RED	LCD_COLOR(0x023f)
+#define COLOR_DARK_ORANGE	LCD_COLOR(0x047f)
+#define COLOR_GRAY		LCD_COLOR(0xbdf7)
+#define COLOR_NAVY		LCD_COLOR(0x8000)
+#define COLOR_ROYAL_BLUE	LCD_COLOR(0xe348)
+#define COLOR_SKY_BLUE		LCD_COLOR(0xee70)
+#define COLOR_TURQUOISE		LCD_COLOR(0xd708)
+#define COLOR_STEEL_BLUE	LCD_COLOR(0xb408)
+#define COLOR_LIGHT_BLUE	LCD_COLOR(0xe6d5)
+#define COLOR_AQUAMARINE	LCD_COLOR(0xd7ef)
+#define COLOR_DARK_GREEN	LCD_COLOR(0x0320)
+#define COLOR_DARK_OLIVE_GREEN	LCD_COLOR(0x2b4a)
+#define COLOR_SEA_GREEN		LCD_COLOR(0x5445)
+#define COLOR_SPRING_GREEN	LCD_COLOR(0x7fe0)
+#define COLOR_PALE_GREEN	LCD_COLOR(0x9fd3)
+#define COLOR_GREEN_YELLOW	LCD_COLOR(0x2ff5)
+#define COLOR_LIME_GREEN	LCD_COLOR(0x3666)
+#define COLOR_FOREST_GREEN	LCD_COLOR(0x2444)
+#define COLOR_KHAKI		LCD_COLOR(0x8f3e)
+#define COLOR_GOLD		LCD_COLOR(0x06bf)
+#define COLOR_GOLDENROD		LCD_COLOR(0x253b)
+#define COLOR_SIENNA		LCD_COLOR(0x2a94)
+#define COLOR_BEIGE		LCD_COLOR(0xdfbe)
+#define COLOR_TAN		LCD_COLOR(0x8dba)
+#define COLOR_BROWN		LCD_COLOR(0x2954)
+#define COLOR_CHOCOLATE		LCD_COLOR(0x1b5a)
+#define COLOR_FIREBRICK		LCD_COLOR(0x2116)
+#define COLOR_HOT_PINK		LCD_COLOR(0xb35f)
+#define COLOR_PINK		LCD_COLOR(0xce1f)
+#define COLOR_DEEP		LCD_COLOR(0x90bf)
+#define COLOR_VIOLET		LCD_COLOR(0xec1d)
+#define COLOR_DARK_VIOLE	LCD_COLOR(0xd012)
+#define COLOR_PURPLE		LCD_COLOR(0xf114)
+#define COLOR_MEDIUM_PURPLE	LCD_COLOR(0xdb92)
 
 #endif /* lcdutils_included */
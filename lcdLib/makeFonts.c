@@ -0,0 +1,55 @@
+// Generate a row-major glyph table for the 11x16 font.
+//
+// font_11x16 stores one 16 bit word per column (bit 0 at the top).  The
+// LCD is written a raster row at a time, so it is emitted as rows of
+// bytes with the leftmost pixel in the most significant bit of the first
+// byte: a renderer just shifts each byte left and tests 0x80.  font_8x12
+// already stores one byte per raster row that way and is used as is.
+
+#include "stdio.h"
+#include "assert.h"
+#include "lcdutils.h"
+
+#define NUM_GLYPHS 95
+
+/* comment naming a glyph; a trailing backslash would continue the comment */
+static const char *
+glyphName(int glyph)
+{
+  static char name[8];
+  int c = glyph + 0x20;
+  sprintf(name, c == '\\' ? "0x%02x" : "0x%02x %c", c, c);
+  return name;
+}
+
+static void
+header(FILE *fp)
+{
+  fprintf(fp, "// Automatically generated by makeFonts.  Do not edit.\n");
+  fprintf(fp, "#include \"lcdutils.h\"\n\n");
+}
+
+int main()
+{
+  int glyph, row, col;
+  FILE *fp;
+
+  fp = fopen("font-11x16-rows.c", "w");
+  assert(fp);
+  header(fp);
+  fprintf(fp, "const unsigned char font_11x16_rows[%d][16][2] = {\n", NUM_GLYPHS);
+  for (glyph = 0; glyph < NUM_GLYPHS; glyph++) {
+    fprintf(fp, "  { // %s\n", glyphName(glyph));
+    for (row = 0; row < 16; row++) {
+      unsigned int bits = 0;	/* leftmost column in bit 15 */
+      for (col = 0; col < 11; col++)
+	if (font_11x16[glyph][col] & (1 << row))
+	  bits |= 0x8000 >> col;
+      fprintf(fp, "    { 0x%02x, 0x%02x },\n", bits >> 8, bits & 0xff);
+    }
+    fprintf(fp, "  },\n");
+  }
+  fprintf(fp, "};\n");
+  fclose(fp);
+  return 0;
+}
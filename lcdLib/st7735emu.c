@@ -0,0 +1,245 @@
+/** \file st7735emu.c
+ *  \brief Host-side stand-in for the ST7735 LCD controller.
+ *
+ *  Decodes the subset of the command set lcdutils uses (SWRESET,
+ *  SLEEPOUT, NORON, DISPON, COLMOD, MADCTL, CASET, PASET, RAMWR,
+ *  VSCRDEF, VSCSAD).  Frame
+ *  memory is addressed the way the controller sees it after MADCTL:
+ *  with MV set, columns run along the 160 pixel edge.  Mirroring (MX,
+ *  MY) is not modelled since it only changes how the panel shows
+ *  memory, not what lcdLib writes.  Vertical scrolling is applied
+ *  along the 160 pixel edge when the display is dumped.
+ */
+
+#include "st7735emu.h"
+
+#define SWRESET		0x01
+#define SLEEPOUT	0x11
+#define NORON		0x13
+#define DISPON		0x29
+#define CASETP		0x2A
+#define PASETP		0x2B
+#define RAMWRP		0x2C
+#define VSCRDEF		0x33
+#define MADCTL		0x36
+#define VSCSAD		0x37
+#define COLMOD		0x3A
+
+#define MADCTL_MV	0x20	/**< row/column exchange */
+#define MADCTL_BGR	0x08	/**< panel expects blue in the high bits */
+
+St7735Stats st7735_stats;
+
+static unsigned short frame[LONG_EDGE_PIXELS * SHORT_EDGE_PIXELS];
+static unsigned long spiHz = 2000000;
+
+static u_char command;		/**< command whose parameters are arriving */
+static u_char params[6];
+static u_char paramCount;
+static u_char madctl, colmod;
+static u_int colStart, colEnd, rowStart, rowEnd;
+static u_int col, row;		/**< RAM write pointer */
+static u_char pixelBytes[3];	/**< partial pixel being assembled */
+static u_char pixelByteCount;
+static u_char scrolling;	/**< VSCSAD seen since reset or NORON */
+static u_int scrollTop, scrollLines, scrollStart;
+
+/** Frame memory dimensions under the current MADCTL */
+static u_int memWidth()
+{
+  return (madctl & MADCTL_MV) ? LONG_EDGE_PIXELS : SHORT_EDGE_PIXELS;
+}
+
+static u_int memHeight()
+{
+  return (madctl & MADCTL_MV) ? SHORT_EDGE_PIXELS : LONG_EDGE_PIXELS;
+}
+
+static void reset()
+{
+  madctl = 0;
+  colmod = 0x06;		/**< 18 bit after reset */
+  colStart = rowStart = 0;
+  colEnd = SHORT_EDGE_PIXELS - 1;
+  rowEnd = LONG_EDGE_PIXELS - 1;
+  command = 0;
+  paramCount = pixelByteCount = 0;
+  scrolling = 0;
+  scrollTop = 0;
+  scrollLines = LONG_EDGE_PIXELS;
+}
+
+/** Frame memory line shown on display line along the 160 pixel edge */
+static u_int scrolledLine(u_int line)
+{
+  if (!scrolling || line < scrollTop || line >= scrollTop + scrollLines)
+    return line;		/**< fixed areas show memory directly */
+  line = scrollStart + (line - scrollTop);
+  if (line >= scrollTop + scrollLines)
+    line -= scrollLines;
+  return line;
+}
+
+/** Store one RGB565 pixel and advance the write pointer */
+static void storePixel(u_int value)
+{
+  if (col < memWidth() && row < memHeight())
+    frame[row * memWidth() + col] = value;
+  st7735_stats.pixels++;
+  if (++col > colEnd) {		/**< pointer wraps within the window */
+    col = colStart;
+    if (++row > rowEnd)
+      row = rowStart;
+  }
+}
+
+/** Assemble pixels from RAMWR data according to COLMOD */
+static void ramWrite(u_char byte)
+{
+  pixelBytes[pixelByteCount++] = byte;
+  switch (colmod & 0x07) {
+  case 0x05:			/**< 16 bit: RRRRRGGG GGGBBBBB */
+    if (pixelByteCount == 2) {
+      storePixel((pixelBytes[0] << 8) | pixelBytes[1]);
+      pixelByteCount = 0;
+    }
+    break;
+  case 0x03:			/**< 12 bit: two pixels in three bytes */
+    if (pixelByteCount == 2) {	/**< first pixel complete */
+      u_int p = (pixelBytes[0] << 4) | (pixelBytes[1] >> 4);
+      storePixel(((p & 0xf00) << 4) | ((p & 0x0f0) << 3) | ((p & 0x00f) << 1));
+    } else if (pixelByteCount == 3) {
+      u_int p = ((pixelBytes[1] & 0x0f) << 8) | pixelBytes[2];
+      storePixel(((p & 0xf00) << 4) | ((p & 0x0f0) << 3) | ((p & 0x00f) << 1));
+      pixelByteCount = 0;
+    }
+    break;
+  default:			/**< 18 bit: one byte per component */
+    if (pixelByteCount == 3) {
+      storePixel(((pixelBytes[0] & 0xf8) << 8) | ((pixelBytes[1] & 0xfc) << 3)
+		 | (pixelBytes[2] >> 3));
+      pixelByteCount = 0;
+    }
+  }
+}
+
+/** Handle a parameter byte of the current command */
+static void parameter(u_char byte)
+{
+  if (command == RAMWRP) {
+    ramWrite(byte);
+    return;
+  }
+  if (paramCount < sizeof(params))
+    params[paramCount] = byte;
+  paramCount++;
+  switch (command) {
+  case COLMOD:
+    colmod = byte;
+    break;
+  case MADCTL:
+    madctl = byte;
+    break;
+  case CASETP:
+    if (paramCount == 4) {
+      colStart = (params[0] << 8) | params[1];
+      colEnd = (params[2] << 8) | params[3];
+    }
+    break;
+  case PASETP:
+    if (paramCount == 4) {
+      rowStart = (params[0] << 8) | params[1];
+      rowEnd = (params[2] << 8) | params[3];
+    }
+    break;
+  case VSCRDEF:			/**< TFA, VSA, BFA */
+    if (paramCount == 4) {
+      scrollTop = (params[0] << 8) | params[1];
+      scrollLines = (params[2] << 8) | params[3];
+    }
+    break;
+  case VSCSAD:
+    if (paramCount == 2) {
+      scrollStart = (params[0] << 8) | params[1];
+      scrolling = 1;
+    }
+    break;
+  }
+}
+
+void st7735_receive(u_char byte, u_char isCommand)
+{
+  if (!isCommand) {
+    st7735_stats.dataBytes++;
+    parameter(byte);
+    return;
+  }
+  st7735_stats.cmdBytes++;
+  command = byte;
+  paramCount = pixelByteCount = 0; /**< a command ends any partial pixel */
+  switch (byte) {
+  case SWRESET:
+    reset();
+    break;
+  case NORON:			/**< leaves scroll mode */
+    scrolling = 0;
+    break;
+  case RAMWRP:
+    col = colStart;
+    row = rowStart;
+    break;
+  }
+}
+
+void st7735_resetStats()
+{
+  st7735_stats.cmdBytes = st7735_stats.dataBytes = st7735_stats.pixels = 0;
+}
+
+void st7735_setSpiClock(unsigned long hz)
+{
+  spiHz = hz;
+}
+
+unsigned long st7735_busMicros()
+{
+  unsigned long long bits = 8ULL * (st7735_stats.cmdBytes + st7735_stats.dataBytes);
+  return (unsigned long)(bits * 1000000ULL / spiHz);
+}
+
+void st7735_printStats(FILE *fp, const char *label)
+{
+  fprintf(fp, "%s: %lu cmd bytes, %lu data bytes, %lu pixels, %lu us at %lu Hz\n",
+	  label, st7735_stats.cmdBytes, st7735_stats.dataBytes,
+	  st7735_stats.pixels, st7735_busMicros(), spiHz);
+}
+
+u_int st7735_getPixel(u_char c, u_char r)
+{
+  if (c >= memWidth() || r >= memHeight())
+    return 0;
+  return frame[r * memWidth() + c];
+}
+
+int st7735_writePPM(const char *path)
+{
+  FILE *fp = fopen(path, "wb");
+  u_int c, r;
+  if (!fp)
+    return -1;
+  fprintf(fp, "P6\n%u %u\n255\n", memWidth(), memHeight());
+  for (r = 0; r < memHeight(); r++) {
+    for (c = 0; c < memWidth(); c++) {
+      u_int v = (madctl & MADCTL_MV)
+	? frame[r * memWidth() + scrolledLine(c)]
+	: frame[scrolledLine(r) * memWidth() + c];
+      u_int hi = v >> 11, green = (v >> 5) & 0x3f, lo = v & 0x1f;
+      u_char rgb[3];
+      rgb[0] = ((madctl & MADCTL_BGR) ? lo : hi) * 255 / 31;
+      rgb[1] = green * 255 / 63;
+      rgb[2] = ((madctl & MADCTL_BGR) ? hi : lo) * 255 / 31;
+      fwrite(rgb, 1, 3, fp);
+    }
+  }
+  return fclose(fp);
+}
@@ -0,0 +1,63 @@
+/** \file st7735emu.h
+ *  \brief Host-side stand-in for the ST7735 LCD controller.
+ *
+ *  When lcdLib is built with -DLCD_EMULATOR (make host), lcdutils feeds
+ *  every SPI byte to st7735_receive() instead of USCI_B0.  The emulator
+ *  decodes the command stream into a 160x128 RGB565 frame memory that
+ *  can be dumped as a PPM image, and counts bus traffic so rendering
+ *  code can be profiled without the board.
+ */
+
+#ifndef st7735emu_included
+#define st7735emu_included
+
+#include <stdio.h>
+#include "lcdutils.h"
+
+/** Bus traffic since the last st7735_resetStats() */
+typedef struct {
+  unsigned long cmdBytes;	/**< bytes sent with D/C low */
+  unsigned long dataBytes;	/**< bytes sent with D/C high */
+  unsigned long pixels;		/**< pixels stored into frame memory */
+} St7735Stats;
+
+extern St7735Stats st7735_stats;
+
+/** Accept one byte from the SPI bus
+ *
+ *  \param byte The byte
+ *  \param isCommand Nonzero if D/C was low (command)
+ */
+void st7735_receive(u_char byte, u_char isCommand);
+
+/** Zero st7735_stats, e.g. at the start of each frame */
+void st7735_resetStats();
+
+/** Set the SPI clock used to estimate bus time (default 2 MHz, SMCLK/1) */
+void st7735_setSpiClock(unsigned long hz);
+
+/** Estimated time the counted bytes occupy the bus, in microseconds */
+unsigned long st7735_busMicros();
+
+/** Print st7735_stats and the bus time estimate on one line
+ *
+ *  \param fp Where to print
+ *  \param label Prefix for the line, e.g. a frame name
+ */
+void st7735_printStats(FILE *fp, const char *label);
+
+/** Write the display as a binary PPM (P6) image
+ *
+ *  Frame memory is shown as the panel would, including any vertical
+ *  scroll set with VSCRDEF/VSCSAD.
+ *
+ *  \param path File to create
+ *  \return 0 on success
+ */
+int st7735_writePPM(const char *path);
+
+/** Read back one pixel of frame memory as the raw 16-bit value
+ *  (memory addressing: vertical scrolling is not applied) */
+u_int st7735_getPixel(u_char col, u_char row);
+
+#endif // st7735emu_included
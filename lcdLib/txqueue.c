@@ -0,0 +1,61 @@
+/** \file txqueue.c
+ *  \brief Ring buffer of bytes bound for the LCD's SPI bus.
+ *
+ *  head and tail are free-running u_chars masked on use, so a full
+ *  queue (head - tail == TXQUEUE_SIZE) is distinguishable from an
+ *  empty one.  Only the producer writes head and only the consumer 
+ *  writes tail, so neither side needs to disable interrupts.
+ */
+
+#include "txqueue.h"
+
+#define TXQUEUE_MASK (TXQUEUE_SIZE - 1)
+
+/** Keeps the compiler from moving the non-volatile entry accesses
+ *  across the head and tail updates that hand entries between the
+ *  two sides (the MSP430 itself does not reorder memory accesses)
+ */
+#define TXQUEUE_BARRIER() __asm__ volatile ("" ::: "memory")
+
+void txQueueInit(TxQueue *q)
+{
+  q->head = q->tail = 0;
+}
+
+u_char txQueueCount(const TxQueue *q)
+{
+  return (u_char)(q->head - q->tail);
+}
+
+u_char txQueuePut(TxQueue *q, u_char byte, u_char isCommand)
+{
+  u_char head = q->head;
+  if ((u_char)(head - q->tail) >= TXQUEUE_SIZE)
+    return 0;			/**< full */
+  TXQUEUE_BARRIER();		/**< write the slot only once it is freed */
+  u_char slot = head & TXQUEUE_MASK;
+  u_char bit = 1 << (slot & 7);
+  q->data[slot] = byte;
+  if (isCommand)
+    q->isCommand[slot >> 3] |= bit;
+  else
+    q->isCommand[slot >> 3] &= ~bit;
+  TXQUEUE_BARRIER();		/**< the entry is complete before... */
+  q->head = head + 1;		/**< ...it is published */
+  return 1;
+}
+
+int txQueueGet(TxQueue *q)
+{
+  u_char tail = q->tail;
+  if (tail == q->head)
+    return -1;			/**< empty */
+  TXQUEUE_BARRIER();		/**< read the entry only once it is published */
+  u_char slot = tail & TXQUEUE_MASK;
+  int entry = q->data[slot];
+  if (q->isCommand[slot >> 3] & (1 << (slot & 7)))
+    entry |= 0x100;
+  TXQUEUE_BARRIER();		/**< done with the slot before freeing it */
+  q->tail = tail + 1;
+  return entry;
+}
@@ -0,0 +1,52 @@
+/** \file txqueue.h
+ *  \brief Ring buffer of bytes bound for the LCD's SPI bus.
+ *
+ *  Each entry remembers whether it is a command or data byte so the
+ *  transmitter can drive the D/C line when the entry is sent.  The
+ *  queue is single-producer (foreground) / single-consumer (TX
+ *  interrupt) and does not touch any hardware.
+ */
+
+#ifndef txqueue_included
+#define txqueue_included
+
+#include "lcdutils.h"
+
+/** Number of entries, must be a power of two; 16 holds the longest
+ *  command burst (lcd_setArea, 11 bytes) */
+#define TXQUEUE_SIZE 16
+
+typedef struct {
+  u_char data[TXQUEUE_SIZE];
+  u_char isCommand[TXQUEUE_SIZE / 8]; /**< one D/C bit per entry */
+  volatile u_char head;		      /**< next slot to fill (producer) */
+  volatile u_char tail;		      /**< next slot to send (consumer) */
+} TxQueue;
+
+/** Empty the queue */
+void txQueueInit(TxQueue *q);
+
+/** Append a byte
+ *
+ *  \param q The queue
+ *  \param byte The byte to send
+ *  \param isCommand Nonzero if the byte is a command (D/C low)
+ *  \return 0 if the queue was full and nothing was added
+ */
+u_char txQueuePut(TxQueue *q, u_char byte, u_char isCommand);
+
+/** Remove the oldest byte
+ *
+ *  \param q The queue
+ *  \return -1 if empty, otherwise the byte in the low 8 bits and 
+ *          its command flag in bit 8
+ */
+int txQueueGet(TxQueue *q);
+
+/** Number of bytes waiting to be sent */
+u_char txQueueCount(const TxQueue *q);
+
+/** True if nothing is waiting to be sent */
+#define txQueueEmpty(q) ((q)->head == (q)->tail)
+
+#endif // txqueue_included
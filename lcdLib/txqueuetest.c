@@ -0,0 +1,84 @@
+/** \file txqueuetest.c
+ *  \brief Host test of the TX queue's ring logic
+ *
+ *  Fills and drains a TxQueue in patterns that wrap head and tail
+ *  (free-running u_chars) many times over, checking the order of
+ *  bytes, their D/C bits, the count, and that a full queue refuses
+ *  bytes and an empty one returns -1.  Prints each failure and exits
+ *  nonzero if there were any.
+ */
+
+#include <stdio.h>
+#include "txqueue.h"
+
+static int failures;
+
+static void
+check(int ok, const char *what, int step)
+{
+  if (!ok) {
+    printf("txqueuetest: %s (step %d)\n", what, step);
+    failures++;
+  }
+}
+
+/** The byte and D/C bit of the n-th byte put: every 3rd is a command */
+#define BYTE_AT(n) ((u_char)((n) * 7 + 1))
+#define COMMAND_AT(n) ((n) % 3 == 0)
+
+int
+main()
+{
+  TxQueue q;
+  int put = 0, got = 0, step, n;
+
+  txQueueInit(&q);
+  check(txQueueEmpty(&q) && txQueueCount(&q) == 0, "new queue not empty", 0);
+  check(txQueueGet(&q) == -1, "get from an empty queue", 0);
+
+  /* fill to the brim: the next put is refused and changes nothing */
+  for (n = 0; n < TXQUEUE_SIZE; n++, put++)
+    check(txQueuePut(&q, BYTE_AT(put), COMMAND_AT(put)), "put refused below full", n);
+  check(txQueueCount(&q) == TXQUEUE_SIZE, "full count", 0);
+  check(!txQueuePut(&q, 0xee, 1), "put accepted when full", 0);
+  check(txQueueCount(&q) == TXQUEUE_SIZE, "refused put changed the count", 0);
+
+  /* uneven put and get bursts carry head and tail round the ring and
+     past 255 many times; every byte must come out once, in order,
+     with its own D/C bit */
+  for (step = 0; step < 5000; step++) {
+    int puts = (step * 5) % (TXQUEUE_SIZE + 3), gets = (step * 3) % (TXQUEUE_SIZE + 5);
+    for (n = 0; n < gets; n++) {
+      int entry = txQueueGet(&q);
+      if (got == put) {
+	check(entry == -1, "get past the last byte", step);
+	break;
+      }
+      check(entry >= 0 && (entry & 0xff) == BYTE_AT(got), "byte out of order", step);
+      check(((entry & 0x100) != 0) == COMMAND_AT(got), "wrong D/C bit", step);
+      got++;
+    }
+    for (n = 0; n < puts; n++) {
+      u_char accepted = txQueuePut(&q, BYTE_AT(put), COMMAND_AT(put));
+      check(accepted == (put - got < TXQUEUE_SIZE), "put accepted or refused wrongly", step);
+      if (!accepted)
+	break;
+      put++;
+    }
+    check(txQueueCount(&q) == put - got, "count", step);
+    check(txQueueEmpty(&q) == (put == got), "empty", step);
+  }
+
+  /* drain */
+  while (got < put) {
+    int entry = txQueueGet(&q);
+    check(entry >= 0 && (entry & 0xff) == BYTE_AT(got)
+	  && ((entry & 0x100) != 0) == COMMAND_AT(got), "drain", got);
+    got++;
+  }
+  check(txQueueGet(&q) == -1 && txQueueEmpty(&q), "drained queue not empty", got);
+
+  printf("txqueuetest: %d bytes through a %d entry queue, %d failures\n",
+	 put, TXQUEUE_SIZE, failures);
+  return failures != 0;
+}
@@ -0,0 +1,485 @@
+/** \file makeScene.c
+ *  \brief Compiles a scene description into a renderer specialized to it
+ *
+ *  usage: makeScene scene-file name
+ *
+ *  Reads a scene (see pong.scene for the format) and writes name.c and
+ *  name.h.  Layers that do not move are composited here, at build time,
+ *  into runs of one color along each row; rows that come out the same
+ *  share one run list.  Moving layers keep a table of their spans for
+ *  each of their rows, in columns from their center.  The generated
+ *  nameDrawRegion() walks a row's baked runs and lays the moving layers'
+ *  spans over them in the scene's fixed front-to-back order, sending
+ *  each run of one color with lcd_fillRun.  It needs only lcdLib.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+void computeChordVec(unsigned char chordVec[], unsigned char radius);
+
+#define MAX_LAYERS 32
+#define MAX_EDGE 160		/* longest screen edge */
+#define MAX_STYLES 64
+#define MAX_SPANS 2		/* per row per layer, as SHAPE_MAX_SPANS */
+#define BACKGROUND_DEPTH 255
+
+typedef struct {
+  char kind[16], name[32], color[48];
+  int params[2];		/* rect, outline: halfSize; circle: radius; rarrow: size */
+  int col, row;			/* center */
+  int moves;
+  int left, top, right, bottom;	/* bounds from the center */
+  unsigned char chords[256];	/* circles */
+} SceneLayer;
+
+typedef struct {		/* a color at a depth, for baked runs */
+  const char *color;
+  int depth;
+} Style;
+
+static SceneLayer layers[MAX_LAYERS];
+static int numLayers, width = 128, height = 160;
+static char background[48] = "COLOR_BLACK";
+
+static Style styles[MAX_STYLES];
+static int numStyles;
+
+static unsigned char runLength[MAX_EDGE * MAX_EDGE], runStyle[MAX_EDGE * MAX_EDGE];
+static int patternFirstRun[MAX_EDGE + 1], numPatterns, numRuns;
+static int rowPattern[MAX_EDGE];
+
+static void
+fail(const char *file, int line, const char *msg)
+{
+  fprintf(stderr, "%s:%d: %s\n", file, line, msg);
+  exit(1);
+}
+
+/** Spans of layer l on the row dRow from its center, in columns from
+ *  its center.  Matches the shape's spans function in shapeLib or
+ *  circleLib exactly.
+ */
+static int
+layerSpans(const SceneLayer *l, int dRow, int starts[], int ends[])
+{
+  int absRow = dRow >= 0 ? dRow : -dRow;
+  if (!strcmp(l->kind, "rect")) {
+    if (absRow > l->params[1])
+      return 0;
+    starts[0] = -l->params[0]; ends[0] = l->params[0];
+    return 1;
+  }
+  if (!strcmp(l->kind, "outline")) {
+    if (absRow > l->params[1])
+      return 0;
+    starts[0] = -l->params[0];
+    if (absRow == l->params[1] || l->params[0] == 0) {
+      ends[0] = l->params[0];
+      return 1;
+    }
+    ends[0] = -l->params[0];
+    starts[1] = ends[1] = l->params[0];
+    return 2;
+  }
+  if (!strcmp(l->kind, "circle")) {
+    int radius = l->params[0], half;
+    if (absRow > radius)
+      return 0;
+    half = l->chords[absRow];
+    while (half < radius && l->chords[half + 1] >= absRow)
+      half++;
+    while (l->chords[half] < absRow)
+      half--;
+    starts[0] = -half; ends[0] = half;
+    return 1;
+  }
+  /* rarrow */
+  {
+    int size = l->params[0], halfSize = size / 2, quarterSize = halfSize / 2;
+    if (absRow > halfSize)
+      return 0;
+    starts[0] = -(absRow <= quarterSize ? size : halfSize);
+    ends[0] = -absRow;
+    return 1;
+  }
+}
+
+static void
+readScene(const char *file)
+{
+  FILE *fp = fopen(file, "r");
+  char line[200];
+  int lineNum = 0;
+  if (!fp) {
+    perror(file);
+    exit(1);
+  }
+  while (fgets(line, sizeof line, fp)) {
+    SceneLayer *l = &layers[numLayers];
+    char kind[16], rest[200];
+    int params;
+    lineNum++;
+    if (sscanf(line, "%15s", kind) != 1 || kind[0] == '#')
+      continue;
+    if (!strcmp(kind, "screen")) {
+      if (sscanf(line, "%*s %d %d", &width, &height) != 2
+	  || width < 1 || width > MAX_EDGE || height < 1 || height > MAX_EDGE)
+	fail(file, lineNum, "expected: screen width height");
+      continue;
+    }
+    if (!strcmp(kind, "background")) {
+      if (sscanf(line, "%*s %47s", background) != 1)
+	fail(file, lineNum, "expected: background color");
+      continue;
+    }
+    if (!strcmp(kind, "rect") || !strcmp(kind, "outline"))
+      params = 2;
+    else if (!strcmp(kind, "circle") || !strcmp(kind, "rarrow"))
+      params = 1;
+    else
+      fail(file, lineNum, "unknown shape (rect, outline, circle or rarrow)");
+    if (numLayers == MAX_LAYERS)
+      fail(file, lineNum, "too many layers");
+    strcpy(l->kind, kind);
+    rest[0] = 0;
+    if (params == 2
+	? sscanf(line, "%*s %31s %d %d %d %d %47s %199[^\n]", l->name, &l->params[0],
+		 &l->params[1], &l->col, &l->row, l->color, rest) < 6
+	: sscanf(line, "%*s %31s %d %d %d %47s %199[^\n]", l->name, &l->params[0],
+		 &l->col, &l->row, l->color, rest) < 5)
+      fail(file, lineNum, "expected: shape name size... col row color [moves]");
+    l->moves = !strncmp(rest, "moves", 5);
+    if (l->params[0] < 0 || l->params[1] < 0)
+      fail(file, lineNum, "sizes must not be negative");
+    if (!strcmp(kind, "circle")) {
+      if (l->params[0] < 2 || l->params[0] > 150)
+	fail(file, lineNum, "circle radius must be 2..150");
+      computeChordVec(l->chords, l->params[0]);
+      l->left = l->top = -l->params[0];
+      l->right = l->bottom = l->params[0];
+    } else if (!strcmp(kind, "rarrow")) {
+      l->left = -l->params[0]; l->right = 0;
+      l->top = -(l->params[0] / 2); l->bottom = l->params[0] / 2;
+    } else {
+      l->left = -l->params[0]; l->right = l->params[0];
+      l->top = -l->params[1]; l->bottom = l->params[1];
+    }
+    if (l->moves && (l->left < -127 || l->right > 127 || l->top < -127))
+      fail(file, lineNum, "moving layers must fit 127 pixels from their center");
+    numLayers++;
+  }
+  fclose(fp);
+}
+
+static int
+styleIndex(const char *color, int depth)
+{
+  int i;
+  for (i = 0; i < numStyles; i++)
+    if (styles[i].depth == depth && !strcmp(styles[i].color, color))
+      return i;
+  if (numStyles == MAX_STYLES) {
+    fprintf(stderr, "too many colors in static layers\n");
+    exit(1);
+  }
+  styles[numStyles].color = color;
+  styles[numStyles].depth = depth;
+  return numStyles++;
+}
+
+/** Composite the static layers into runs, sharing identical rows */
+static void
+bakeStatic()
+{
+  int row, col, i, p;
+  for (row = 0; row < height; row++) {
+    int owner[MAX_EDGE];	/* style of each column */
+    int first = numRuns;
+    for (col = 0; col < width; col++)
+      owner[col] = styleIndex(background, BACKGROUND_DEPTH);
+    for (i = numLayers - 1; i >= 0; i--) { /* back to front */
+      const SceneLayer *l = &layers[i];
+      int starts[MAX_SPANS], ends[MAX_SPANS], n, s;
+      if (l->moves)
+	continue;
+      n = layerSpans(l, row - l->row, starts, ends);
+      for (s = 0; s < n; s++)
+	for (col = l->col + starts[s]; col <= l->col + ends[s]; col++)
+	  if (col >= 0 && col < width)
+	    owner[col] = styleIndex(l->color, i);
+    }
+    for (col = 0; col < width; ) {
+      int end = col;
+      while (end + 1 < width && owner[end + 1] == owner[col])
+	end++;
+      runLength[numRuns] = end - col + 1;
+      runStyle[numRuns++] = owner[col];
+      col = end + 1;
+    }
+    for (p = 0; p < numPatterns; p++) { /* same as an earlier row? */
+      int count = patternFirstRun[p + 1] - patternFirstRun[p];
+      if (count == numRuns - first
+	  && !memcmp(&runLength[patternFirstRun[p]], &runLength[first], count)
+	  && !memcmp(&runStyle[patternFirstRun[p]], &runStyle[first], count))
+	break;
+    }
+    if (p < numPatterns)
+      numRuns = first;		/* reuse it */
+    else
+      patternFirstRun[++numPatterns] = numRuns;
+    rowPattern[row] = p;
+  }
+}
+
+/** "paddleLeft" -> "PADDLE_LEFT" */
+static void
+macroName(char *out, const char *in)
+{
+  const char *first = in;
+  for (; *in; in++) {
+    if (isupper((unsigned char)*in) && in != first && in[-1] != '_')
+      *out++ = '_';
+    *out++ = toupper((unsigned char)*in);
+  }
+  *out = 0;
+}
+
+static void
+writeHeader(const char *scene, const char *name, const char *NAME)
+{
+  char file[100], macro[80];
+  FILE *fp;
+  int i, movers = 0;
+  sprintf(file, "%s.h", name);
+  fp = fopen(file, "w");
+  if (!fp) {
+    perror(file);
+    exit(1);
+  }
+  fprintf(fp, "// Automatically generated by makeScene from %s\n", scene);
+  fprintf(fp, "#ifndef %s_included\n#define %s_included\n\n", name, name);
+  fprintf(fp, "#include \"shape.h\"\n\n");
+  fprintf(fp, "/** Moving layers, front to back */\n");
+  for (i = 0; i < numLayers; i++)
+    if (layers[i].moves) {
+      macroName(macro, layers[i].name);
+      fprintf(fp, "#define %s_%s %d\n", NAME, macro, movers++);
+    }
+  fprintf(fp, "#define %s_MOVERS %d\n\n", NAME, movers);
+  if (movers) {
+    fprintf(fp, "/** Centers of the moving layers; set these, then redraw */\n");
+    fprintf(fp, "extern Vec2 %sPos[%s_MOVERS];\n\n", name, NAME);
+    fprintf(fp, "/** Bounding box of moving layer i centered at pos */\n");
+    fprintf(fp, "void %sBounds(u_char i, const Vec2 *pos, Region *bounds);\n\n", name);
+  }
+  fprintf(fp, "/** Render the scene within area (inclusive of botRight) */\n");
+  fprintf(fp, "void %sDrawRegion(const Region *area);\n\n", name);
+  fprintf(fp, "/** Render the whole screen */\n");
+  fprintf(fp, "void %sDraw();\n\n", name);
+  fprintf(fp, "#endif // included\n");
+  fclose(fp);
+}
+
+static void
+writeSource(const char *scene, const char *name, const char *NAME)
+{
+  char file[100];
+  FILE *fp;
+  int i, r, n, movers = 0, maxCover = 0, mover;
+  sprintf(file, "%s.c", name);
+  fp = fopen(file, "w");
+  if (!fp) {
+    perror(file);
+    exit(1);
+  }
+  fprintf(fp, "// Automatically generated by makeScene from %s\n", scene);
+  fprintf(fp, "#include \"lcdutils.h\"\n#include \"%s.h\"\n\n", name);
+  fprintf(fp, "#if screenWidth != %d || screenHeight != %d\n", width, height);
+  fprintf(fp, "#error %s was compiled for a %dx%d screen\n#endif\n\n", scene, width, height);
+  fprintf(fp, "typedef struct { signed char start, end; } SceneSpan;\n");
+  fprintf(fp, "typedef struct { u_char count; SceneSpan spans[%d]; } SceneRow;\n", MAX_SPANS);
+  fprintf(fp, "typedef struct { int start, end; u_int color; u_char depth; } SceneCover;\n\n");
+
+  fprintf(fp, "/* colors of the baked runs */\n");
+  fprintf(fp, "static const u_int styleColor[%d] = {", numStyles);
+  for (i = 0; i < numStyles; i++)
+    fprintf(fp, "%s %s", i ? "," : "", styles[i].color);
+  fprintf(fp, " };\n\n");
+
+  fprintf(fp, "/* the static layers' distinct rows as runs of one style */\n");
+  fprintf(fp, "static const u_char runLength[%d] = {", numRuns);
+  for (i = 0; i < numRuns; i++)
+    fprintf(fp, "%s%s%d", i ? "," : "", i % 16 ? " " : "\n  ", runLength[i]);
+  fprintf(fp, "\n};\nstatic const u_char runStyle[%d] = {", numRuns);
+  for (i = 0; i < numRuns; i++)
+    fprintf(fp, "%s%s%d", i ? "," : "", i % 16 ? " " : "\n  ", runStyle[i]);
+  fprintf(fp, "\n};\nstatic const u_int patternFirstRun[%d] = {", numPatterns);
+  for (i = 0; i < numPatterns; i++)
+    fprintf(fp, "%s%s%d", i ? "," : "", i % 16 ? " " : "\n  ", patternFirstRun[i]);
+  fprintf(fp, "\n};\nstatic const u_char rowPattern[%d] = {", height);
+  for (i = 0; i < height; i++)
+    fprintf(fp, "%s%s%d", i ? "," : "", i % 16 ? " " : "\n  ", rowPattern[i]);
+  fprintf(fp, "\n};\n\n");
+
+  for (i = 0; i < numLayers; i++) {
+    const SceneLayer *l = &layers[i];
+    int most = 0;
+    if (!l->moves)
+      continue;
+    fprintf(fp, "/* %s %s: spans of each row from its top, in columns from its center */\n",
+	    l->kind, l->name);
+    fprintf(fp, "static const SceneRow %sRows[%d] = {\n", l->name, l->bottom - l->top + 1);
+    for (r = l->top; r <= l->bottom; r++) {
+      int starts[MAX_SPANS], ends[MAX_SPANS], s;
+      n = layerSpans(l, r, starts, ends);
+      fprintf(fp, "  {%d, {", n);
+      for (s = 0; s < n; s++)
+	fprintf(fp, "%s{%d, %d}", s ? ", " : "", starts[s], ends[s]);
+      fprintf(fp, "}},\n");
+      if (n > most)
+	most = n;
+    }
+    fprintf(fp, "};\n\n");
+    maxCover += most;
+  }
+
+  if (maxCover) {
+    fprintf(fp, "/* depths of the baked runs' layers, to order moving layers' spans */\n");
+    fprintf(fp, "static const u_char styleDepth[%d] = {", numStyles);
+    for (i = 0; i < numStyles; i++)
+      fprintf(fp, "%s %d", i ? "," : "", styles[i].depth);
+    fprintf(fp, " };\n\n");
+    fprintf(fp, "Vec2 %sPos[%s_MOVERS] = {", name, NAME);
+    for (i = 0; i < numLayers; i++)
+      if (layers[i].moves)
+	fprintf(fp, "%s {{%d, %d}}", movers++ ? "," : "", layers[i].col, layers[i].row);
+    fprintf(fp, " };\n\n");
+    fprintf(fp, "/* left, top, right, bottom of each moving layer from its center */\n");
+    fprintf(fp, "static const signed char moverExtent[%s_MOVERS][4] = {", NAME);
+    for (i = 0, mover = 0; i < numLayers; i++)
+      if (layers[i].moves)
+	fprintf(fp, "%s {%d, %d, %d, %d}", mover++ ? "," : "",
+		layers[i].left, layers[i].top, layers[i].right, layers[i].bottom);
+    fprintf(fp, " };\n\n");
+    fprintf(fp,
+	    "void\n"
+	    "%sBounds(u_char i, const Vec2 *pos, Region *bounds)\n"
+	    "{\n"
+	    "  bounds->topLeft.axes[0] = pos->axes[0] + moverExtent[i][0];\n"
+	    "  bounds->topLeft.axes[1] = pos->axes[1] + moverExtent[i][1];\n"
+	    "  bounds->botRight.axes[0] = pos->axes[0] + moverExtent[i][2];\n"
+	    "  bounds->botRight.axes[1] = pos->axes[1] + moverExtent[i][3];\n"
+	    "}\n\n", name);
+    fprintf(fp,
+	    "/* append a moving layer's spans on a row, in screen columns */\n"
+	    "static int\n"
+	    "addSpans(SceneCover *cover, int n, const SceneRow *row, int col, u_int color, u_char depth)\n"
+	    "{\n"
+	    "  u_char i;\n"
+	    "  for (i = 0; i < row->count && n < %d; i++, n++) { /* n never reaches the bound */\n"
+	    "    cover[n].start = col + row->spans[i].start;\n"
+	    "    cover[n].end = col + row->spans[i].end;\n"
+	    "    cover[n].color = color;\n"
+	    "    cover[n].depth = depth;\n"
+	    "  }\n"
+	    "  return n;\n"
+	    "}\n\n", maxCover);
+  }
+
+  fprintf(fp,
+	  "void\n"
+	  "%sDrawRegion(const Region *area)\n"
+	  "{\n"
+	  "  int col0 = area->topLeft.axes[0], row0 = area->topLeft.axes[1];\n"
+	  "  int col1 = area->botRight.axes[0], row1 = area->botRight.axes[1];\n"
+	  "  int row;\n"
+	  "  if (col0 < 0) col0 = 0;\n"
+	  "  if (row0 < 0) row0 = 0;\n"
+	  "  if (col1 > screenWidth - 1) col1 = screenWidth - 1;\n"
+	  "  if (row1 > screenHeight - 1) row1 = screenHeight - 1;\n"
+	  "  if (col0 > col1 || row0 > row1)\n"
+	  "    return;\n"
+	  "  lcd_setArea(col0, row0, col1, row1);\n"
+	  "  for (row = row0; row <= row1; row++) {\n"
+	  "    u_int run = patternFirstRun[rowPattern[row]];\n"
+	  "    int col, runEnd = runLength[run] - 1;\n", name);
+  if (maxCover) {
+    fprintf(fp, "    SceneCover cover[%d];\n", maxCover);
+    fprintf(fp, "    int n = 0;\n");
+    fprintf(fp, "    u_int d;\n\n");
+    fprintf(fp, "    /* moving layers, front to back */\n");
+    for (i = 0, mover = 0; i < numLayers; i++) {
+      const SceneLayer *l = &layers[i];
+      if (!l->moves)
+	continue;
+      fprintf(fp, "    d = row - %sPos[%d].axes[1] + %d;\n", name, mover, -l->top);
+      fprintf(fp, "    if (d < %d)\n", l->bottom - l->top + 1);
+      fprintf(fp, "      n = addSpans(cover, n, &%sRows[d], %sPos[%d].axes[0], %s, %d);\n",
+	      l->name, name, mover, l->color, i);
+      mover++;
+    }
+  }
+  fprintf(fp,
+	  "\n"
+	  "    for (col = col0; col <= col1; ) {\n"
+	  "      int end;\n"
+	  "      u_int color;\n");
+  if (maxCover)
+    fprintf(fp,
+	    "      int i;\n"
+	    "      u_char depth;\n");
+  fprintf(fp,
+	  "      while (runEnd < col)\n"
+	  "\trunEnd += runLength[++run];\n"
+	  "      color = styleColor[runStyle[run]];\n"
+	  "      end = runEnd < col1 ? runEnd : col1;\n");
+  if (maxCover)
+    fprintf(fp,
+	    "      depth = styleDepth[runStyle[run]];\n"
+	    "      for (i = 0; i < n && cover[i].depth < depth; i++) {\n"
+	    "\tif (cover[i].start > col) {\t/* may take over later in the run */\n"
+	    "\t  if (cover[i].start <= end)\n"
+	    "\t    end = cover[i].start - 1;\n"
+	    "\t} else if (cover[i].end >= col) {\n"
+	    "\t  color = cover[i].color;\n"
+	    "\t  if (cover[i].end < end)\n"
+	    "\t    end = cover[i].end;\n"
+	    "\t  break;\n"
+	    "\t}\n"
+	    "      }\n");
+  fprintf(fp,
+	  "      lcd_fillRun(color, end - col + 1);\n"
+	  "      col = end + 1;\n"
+	  "    }\n"
+	  "  }\n"
+	  "}\n\n"
+	  "void\n"
+	  "%sDraw()\n"
+	  "{\n"
+	  "  Region screen = {{{0, 0}}, {{screenWidth-1, screenHeight-1}}};\n"
+	  "  %sDrawRegion(&screen);\n"
+	  "}\n", name, name);
+  fclose(fp);
+}
+
+int
+main(int argc, char **argv)
+{
+  char NAME[80];
+  int i;
+  if (argc != 3) {
+    fprintf(stderr, "usage: makeScene scene-file name\n");
+    return 1;
+  }
+  readScene(argv[1]);
+  bakeStatic();
+  for (i = 0; argv[2][i] && i < 79; i++)
+    NAME[i] = toupper((unsigned char)argv[2][i]);
+  NAME[i] = 0;
+  writeHeader(argv[1], argv[2], NAME);
+  writeSource(argv[1], argv[2], NAME);
+  return 0;
+}
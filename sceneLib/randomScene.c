@@ -0,0 +1,39 @@
+/** \file randomScene.c
+ *  \brief Writes a random scene for checking makeScene (host)
+ *
+ *  usage: randomScene seed > file.scene
+ *
+ *  One to ten layers of every kind, about half of them moving, with
+ *  random sizes, centers (some off the screen) and colors.  Colors are
+ *  numbers, as scenecheck needs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int
+main(int argc, char **argv)
+{
+  static const char *kinds[] = {"rect", "outline", "circle", "rarrow"};
+  static const int radii[] = {2, 3, 5, 7, 10, 14, 20, 30, 45, 60};
+  int seed = argc > 1 ? atoi(argv[1]) : 1, n, i;
+
+  srand(seed);
+  n = 1 + rand() % 10;
+  printf("# random scene %d, front to back\n", seed);
+  printf("background 0x%04x\n", rand() & 0xffff);
+  for (i = 0; i < n; i++) {
+    const char *kind = kinds[rand() % 4];
+    int moves = rand() % 2;
+    printf("%-7s l%d ", kind, i);
+    if (kind[0] == 'c')
+      printf("%d ", radii[rand() % 10]);
+    else if (kind[1] == 'a')	/* rarrow */
+      printf("%d ", rand() % 61);
+    else
+      printf("%d %d ", rand() % 41, rand() % 41);
+    printf("%d %d 0x%04x%s\n", rand() % 171 - 20, rand() % 201 - 20,
+	   rand() & 0xffff, moves ? " moves" : "");
+  }
+  return 0;
+}
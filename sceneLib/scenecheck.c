@@ -0,0 +1,200 @@
+/** \file scenecheck.c
+ *  \brief Host check of a makeScene renderer against layerDrawRegion
+ *
+ *  usage: scenecheck scene-file [seed]
+ *
+ *  Built with the renderer makeScene wrote for scene-file under the
+ *  name "check" ("make check" does this for random scenes).  Reads the
+ *  same scene into a shapeLib Layer list and, for a number of trials,
+ *  puts the moving layers at random places (partly off the screen) and
+ *  draws a random region both ways in the ST7735 emulator.  The trials
+ *  run again with the static layers baked, if they fit a
+ *  LayerBackground.  Exits nonzero if a pixel differs.
+ *
+ *  Colors in the scene must be numbers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lcdutils.h"
+#include "shape.h"
+#include "_abCircle.h"
+#include "st7735emu.h"
+#include "check.h"
+
+#ifdef SHAPE_COMPACT
+#error scenecheck reads raw colors: build it with the default layout
+#endif
+
+void computeChordVec(unsigned char chordVec[], unsigned char radius);
+
+#define MAX_LAYERS 32		/* as makeScene */
+#define TRIALS 40
+
+u_int bgColor;
+
+static Layer layers[MAX_LAYERS];
+static Layer *movers[CHECK_MOVERS + 1]; /* + 1: scenes may have none */
+static int numLayers;
+static u_int want[screenHeight][screenWidth];
+
+static void
+fail(const char *file, int line, const char *msg)
+{
+  fprintf(stderr, "%s:%d: %s\n", file, line, msg);
+  exit(1);
+}
+
+/** A copy of shape in the heap, for shapes with const fields */
+static AbShape *
+shapeCopy(const void *shape, size_t size)
+{
+  void *copy = malloc(size);
+  memcpy(copy, shape, size);
+  return copy;
+}
+
+static u_int
+colorNumber(const char *file, int line, const char *color)
+{
+  char *end;
+  long n = strtol(color, &end, 0);
+  if (*end || n < 0 || n > 0xffff)
+    fail(file, line, "colors must be numbers");
+  return n;
+}
+
+/** Read the scene (see pong.scene) into layers and movers */
+static void
+readScene(const char *file)
+{
+  FILE *fp = fopen(file, "r");
+  char line[200];
+  int lineNum = 0, numMovers = 0;
+  if (!fp) {
+    perror(file);
+    exit(1);
+  }
+  while (fgets(line, sizeof line, fp)) {
+    Layer *l = &layers[numLayers];
+    char kind[16], name[32], color[48], rest[200];
+    int p0, p1 = 0, col, row;
+    lineNum++;
+    if (sscanf(line, "%15s", kind) != 1 || kind[0] == '#')
+      continue;
+    if (!strcmp(kind, "screen"))
+      fail(file, lineNum, "the emulator's screen size only");
+    if (!strcmp(kind, "background")) {
+      if (sscanf(line, "%*s %47s", color) != 1)
+	fail(file, lineNum, "expected: background color");
+      bgColor = colorNumber(file, lineNum, color);
+      continue;
+    }
+    if (numLayers == MAX_LAYERS)
+      fail(file, lineNum, "too many layers");
+    rest[0] = 0;
+    if (!strcmp(kind, "rect") || !strcmp(kind, "outline")
+	? sscanf(line, "%*s %31s %d %d %d %d %47s %199[^\n]", name, &p0, &p1,
+		 &col, &row, color, rest) < 6
+	: sscanf(line, "%*s %31s %d %d %d %47s %199[^\n]", name, &p0,
+		 &col, &row, color, rest) < 5)
+      fail(file, lineNum, "expected: shape name size... col row color [moves]");
+    if (!strcmp(kind, "rect")) {
+      AbRect rect = {abRectGetBounds, abRectCheck, abRectSpans, {{p0, p1}}};
+      l->abShape = shapeCopy(&rect, sizeof rect);
+    } else if (!strcmp(kind, "outline")) {
+      AbRectOutline outline = {
+	abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineSpans, {{p0, p1}}
+      };
+      l->abShape = shapeCopy(&outline, sizeof outline);
+    } else if (!strcmp(kind, "circle")) {
+      u_char *chords = malloc(p0 + 1);
+      AbCircle circle = {abCircleGetBounds, abCircleCheck, abCircleSpans, chords, p0};
+      computeChordVec(chords, p0);
+      l->abShape = shapeCopy(&circle, sizeof circle);
+    } else if (!strcmp(kind, "rarrow")) {
+      AbRArrow arrow = {abRArrowGetBounds, abRArrowCheck, abRArrowSpans, p0};
+      l->abShape = shapeCopy(&arrow, sizeof arrow);
+    } else
+      fail(file, lineNum, "unknown shape (rect, outline, circle or rarrow)");
+    l->pos.axes[0] = col;
+    l->pos.axes[1] = row;
+    l->color = colorNumber(file, lineNum, color);
+    if (!strncmp(rest, "moves", 5)) {
+      if (numMovers == CHECK_MOVERS)
+	fail(file, lineNum, "more moving layers than check.h has");
+      movers[numMovers++] = l;
+    } else
+      l->flags = LAYER_STATIC;
+    if (numLayers)
+      layers[numLayers - 1].next = l;
+    numLayers++;
+  }
+  fclose(fp);
+  if (!numLayers || numMovers != CHECK_MOVERS)
+    fail(file, lineNum, "scene does not match check.h");
+}
+
+/** Draw random regions both ways; returns the pixels that differ */
+static long
+trials()
+{
+  long differ = 0;
+  int trial, row, col;
+  for (trial = 0; trial < TRIALS; trial++) {
+    Region area, clipped;
+#if CHECK_MOVERS
+    int i;
+    for (i = 0; i < CHECK_MOVERS; i++) {
+      movers[i]->pos.axes[0] = rand() % 200 - 40;
+      movers[i]->pos.axes[1] = rand() % 230 - 40;
+      checkPos[i] = movers[i]->pos;
+    }
+#endif
+    area.topLeft.axes[0] = rand() % 140 - 10;
+    area.topLeft.axes[1] = rand() % 170 - 10;
+    area.botRight.axes[0] = area.topLeft.axes[0] + rand() % 60;
+    area.botRight.axes[1] = area.topLeft.axes[1] + rand() % 80;
+    clipped = area;
+    regionClipScreen(&clipped);
+    if (!regionArea(&clipped))
+      continue;
+    layerDrawRegion(layers, &clipped);
+    lcd_flush();
+    for (row = clipped.topLeft.axes[1]; row <= clipped.botRight.axes[1]; row++)
+      for (col = clipped.topLeft.axes[0]; col <= clipped.botRight.axes[0]; col++)
+	want[row][col] = st7735_getPixel(col, row);
+    checkDrawRegion(&area);
+    lcd_flush();
+    for (row = clipped.topLeft.axes[1]; row <= clipped.botRight.axes[1]; row++)
+      for (col = clipped.topLeft.axes[0]; col <= clipped.botRight.axes[0]; col++)
+	differ += st7735_getPixel(col, row) != want[row][col];
+  }
+  return differ;
+}
+
+int
+main(int argc, char **argv)
+{
+  static LayerRun runs[255];
+  static LayerBand bands[screenHeight];
+  static LayerBackground background = {runs, bands, 255, screenHeight, 0, 0};
+  long differ;
+  if (argc < 2) {
+    fprintf(stderr, "usage: scenecheck scene-file [seed]\n");
+    return 2;
+  }
+  readScene(argv[1]);
+  srand(argc > 2 ? atoi(argv[2]) : 1);
+  lcd_init();
+  layerInit(layers);
+  differ = trials();
+  if (layerBakeStatic(layers, &background))
+    differ += trials();
+  if (differ) {
+    printf("scenecheck: %s: %ld pixels differ from layerDrawRegion\n", argv[1], differ);
+    return 1;
+  }
+  return 0;
+}
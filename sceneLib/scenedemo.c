@@ -0,0 +1,62 @@
+/** \file scenedemo.c
+ *  \brief Bounces the ball of pong.scene with the paddles following it,
+ *  drawn by the renderer makeScene generated for the scene.
+ */
+#include <msp430.h>
+#include <libTimer.h>
+#include "lcdutils.h"
+#include "shape.h"
+#include "pong.h"
+
+u_int bgColor = COLOR_BLACK;	/* shapeLib's; the scene bakes its own */
+
+static DirtyList dirty;
+
+/** dirtyFlushWith's callback; the scene needs no Layer list */
+static void
+drawScene(Layer *layers, const Region *area)
+{
+  pongDrawRegion(area);
+}
+
+/** Move a moving layer, marking where it was and where it will be */
+static void
+moveTo(u_char mover, const Vec2 *pos)
+{
+  Region bounds;
+  pongBounds(mover, &pongPos[mover], &bounds);
+  dirtyAdd(&dirty, &bounds);
+  pongPos[mover] = *pos;
+  pongBounds(mover, pos, &bounds);
+  dirtyAdd(&dirty, &bounds);
+}
+
+int
+main()
+{
+  Vec2 velocity = {1, -3};
+
+  configureClocks();
+  lcd_init();
+  dirtyInit(&dirty);
+  pongDraw();
+
+  for (;;) {
+    Vec2 ball, paddle;
+    vec2Add(&ball, &pongPos[PONG_BALL], &velocity);
+    if (ball.axes[0] < 15 || ball.axes[0] > screenWidth - 15)
+      velocity.axes[0] = -velocity.axes[0];
+    if (ball.axes[1] < 14 || ball.axes[1] > screenHeight - 14)
+      velocity.axes[1] = -velocity.axes[1]; /* off a paddle */
+    vec2Add(&ball, &pongPos[PONG_BALL], &velocity);
+    moveTo(PONG_BALL, &ball);
+    paddle = pongPos[PONG_PADDLE_LEFT];
+    paddle.axes[0] = ball.axes[0];
+    moveTo(PONG_PADDLE_LEFT, &paddle);
+    paddle = pongPos[PONG_PADDLE_RIGHT];
+    paddle.axes[0] = ball.axes[0];
+    moveTo(PONG_PADDLE_RIGHT, &paddle);
+    dirtyFlushWith(&dirty, 0, drawScene);
+    __delay_cycles(200000);
+  }
+}
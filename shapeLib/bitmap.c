@@ -0,0 +1,69 @@
+#include "shape.h"
+
+// column and row of the mask's top left pixel for bitmap at centerPos
+static void
+abBitmapOrigin(const AbBitmap *bitmap, const Vec2 *centerPos, Vec2 *origin)
+{
+  origin->axes[0] = centerPos->axes[0] - bitmap->size.axes[0] / 2;
+  origin->axes[1] = centerPos->axes[1] - bitmap->size.axes[1] / 2;
+}
+
+// bytes per row of the mask
+#define abBitmapStride(bitmap) (((bitmap)->size.axes[0] + 7) >> 3)
+
+void
+abBitmapGetBounds(const AbBitmap *bitmap, const Vec2 *centerPos, Region *bounds)
+{
+  abBitmapOrigin(bitmap, centerPos, &bounds->topLeft);
+  bounds->botRight.axes[0] = bounds->topLeft.axes[0] + bitmap->size.axes[0] - 1;
+  bounds->botRight.axes[1] = bounds->topLeft.axes[1] + bitmap->size.axes[1] - 1;
+}
+
+// true if pixel's bit is set in bitmap's mask
+int
+abBitmapCheck(const AbBitmap *bitmap, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  Vec2 origin;
+  u_int col, row;
+  abBitmapOrigin(bitmap, centerPos, &origin);
+  col = pixel->axes[0] - origin.axes[0]; /* unsigned: left of origin wraps */
+  row = pixel->axes[1] - origin.axes[1];
+  if (col >= (u_int)bitmap->size.axes[0] || row >= (u_int)bitmap->size.axes[1])
+    return 0;
+  return (bitmap->bits[row * abBitmapStride(bitmap) + (col >> 3)] & (0x80 >> (col & 7))) != 0;
+}
+
+// runs of set bits in row, skipping whole bytes of clear or set bits
+int
+abBitmapSpans(const AbBitmap *bitmap, const Vec2 *centerPos, int row, Span *spans)
+{
+  Vec2 origin;
+  const u_char *bits;
+  int col, width = bitmap->size.axes[0], n = 0;
+  u_char inRun = 0;
+  abBitmapOrigin(bitmap, centerPos, &origin);
+  row -= origin.axes[1];
+  if (row < 0 || row >= bitmap->size.axes[1])
+    return 0;
+  bits = bitmap->bits + row * abBitmapStride(bitmap);
+  for (col = 0; col < width; ) {
+    u_char byte = bits[col >> 3];
+    if (!(col & 7) && byte == (inRun ? 0xff : 0x00)) {
+      col += 8;
+      continue;
+    }
+    if (((byte & (0x80 >> (col & 7))) != 0) != inRun) {
+      if (inRun)
+	spans[n++].end = origin.axes[0] + col - 1;
+      else if (n == SHAPE_MAX_SPANS)
+	return -1;
+      else
+	spans[n].start = origin.axes[0] + col;
+      inRun = !inRun;
+    }
+    col++;
+  }
+  if (inRun)
+    spans[n++].end = origin.axes[0] + width - 1;
+  return n;
+}
@@ -0,0 +1,149 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+void
+dirtyInit(DirtyList *dirty)
+{
+  dirty->count = 0;
+  dirty->pixelsPending = dirty->pixelsAdded = dirty->pixelsDrawn = 0;
+}
+
+static void
+dirtyRemove(DirtyList *dirty, u_char i)
+{
+  dirty->rects[i] = dirty->rects[--dirty->count];
+}
+
+/** Pixels the bounding box of a and b covers beyond them (private) */
+static u_int
+dirtyWaste(const Region *a, const Region *b)
+{
+  Region u;
+  u_int parts = regionArea(a) + regionArea(b);
+  regionUnion(&u, a, b);
+  return regionArea(&u) > parts ? regionArea(&u) - parts : 0;
+}
+
+/** Most pieces of a new rectangle waiting to be stored (private) */
+#define DIRTY_PIECES 6
+
+/** Store r, split around the rectangles it overlaps (private)
+ *  Pieces wait on a fixed worklist, each with the index of the first
+ *  rectangle it may still overlap: the earlier ones were cut out.  A
+ *  piece whose cut would overflow the worklist is merged into the
+ *  rectangle it overlaps instead.
+ */
+static void
+dirtySplit(DirtyList *dirty, const Region *r)
+{
+  Region work[DIRTY_PIECES], piece;
+  u_char from[DIRTY_PIECES];
+  u_char n = 1, i, j, bestI, bestJ;
+  u_int waste, bestWaste;
+  work[0] = *r;
+  from[0] = 0;
+  while (n) {
+    piece = work[--n];
+    for (i = from[n]; i < dirty->count; i++)
+      if (regionOverlaps(&piece, &dirty->rects[i]))
+	break;
+    if (i < dirty->count) {	/* cut out rects[i] */
+      if (n + 4 <= DIRTY_PIECES) {
+	j = regionSubtract(&work[n], &piece, &dirty->rects[i]);
+	while (j--)
+	  from[n++] = i + 1;
+      } else
+	regionUnion(&dirty->rects[i], &dirty->rects[i], &piece);
+      continue;
+    }
+    if (dirty->count < DIRTY_MAX) {
+      dirty->rects[dirty->count++] = piece;
+      continue;
+    }
+    bestI = bestJ = 0;
+    bestWaste = 0xffff;
+    for (i = 0; i < dirty->count; i++) { /* full: merge the cheapest pair */
+      for (j = i + 1; j <= dirty->count; j++) {
+	waste = dirtyWaste(&dirty->rects[i],
+			   j < dirty->count ? &dirty->rects[j] : &piece);
+	if (waste < bestWaste) {
+	  bestWaste = waste;
+	  bestI = i;
+	  bestJ = j;
+	}
+      }
+    }
+    if (bestJ == dirty->count) { /* the piece itself */
+      regionUnion(&dirty->rects[bestI], &piece, &dirty->rects[bestI]);
+      continue;
+    }
+    regionUnion(&dirty->rects[bestI], &dirty->rects[bestI], &dirty->rects[bestJ]);
+    dirtyRemove(dirty, bestJ);
+    work[n++] = piece;
+    for (i = 0; i < n; i++)	/* rects grew and moved: recheck them all */
+      from[i] = 0;
+  }
+}
+
+void
+dirtyAdd(DirtyList *dirty, const Region *region)
+{
+  Region r = *region;
+  u_char i;
+  regionClipScreen(&r);
+  if (!regionArea(&r))
+    return;
+  dirty->pixelsPending += regionArea(&r);
+ restart:
+  for (i = 0; i < dirty->count; i++) { /* merge when it costs nothing */
+    if (!dirtyWaste(&r, &dirty->rects[i])) {
+      regionUnion(&r, &r, &dirty->rects[i]);
+      dirtyRemove(dirty, i);
+      goto restart;		/* the union may now reach others */
+    }
+  }
+  dirtySplit(dirty, &r);		/* else split around overlaps */
+}
+
+void
+dirtyAddLayer(DirtyList *dirty, const Layer *layer)
+{
+  Region bounds, boundsLast;
+  Vec2 at;
+  abShapeGetBounds(layer->abShape, LAYER_VEC2(layer->pos, at), &bounds);
+  abShapeGetBounds(layer->abShape, LAYER_VEC2(layer->posLast, at), &boundsLast);
+  dirtyAddMove(dirty, &bounds, &boundsLast);
+}
+
+/* The new bounds go in whole, since a shape's pixels change inside
+ * them.  The old ones follow: dirtyAdd merges them in when the two line
+ * up, and otherwise dirtySplit cuts them around the new ones, down to
+ * the strips they alone cover.
+ */
+void
+dirtyAddMove(DirtyList *dirty, const Region *bounds, const Region *boundsLast)
+{
+  dirtyAdd(dirty, bounds);
+  dirtyAdd(dirty, boundsLast);
+}
+
+void
+dirtyFlush(DirtyList *dirty, Layer *layers)
+{
+  dirtyFlushWith(dirty, layers, layerDrawRegion);
+}
+
+void
+dirtyFlushWith(DirtyList *dirty, Layer *layers,
+	       void (*draw)(Layer *layers, const Region *area))
+{
+  u_char i;
+  dirty->pixelsDrawn = 0;
+  for (i = 0; i < dirty->count; i++) {
+    (*draw)(layers, &dirty->rects[i]);
+    dirty->pixelsDrawn += regionArea(&dirty->rects[i]);
+  }
+  dirty->pixelsAdded = dirty->pixelsPending;
+  dirty->pixelsPending = 0;
+  dirty->count = 0;
+}
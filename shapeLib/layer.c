@@ -2,25 +2,51 @@
 #include "lcddraw.h"
 #include "shape.h"
 
+const LayerBackground *layerBackground = 0;
+
+#define LAYER_RENDER_NAME layerDrawRows
+#include "layerRender.h"
+
+void
+layerDrawRegion(Layer *layers, const Region *area)
+{
+  layerDrawRows(layers, area, 0);
+}
+
+void
+layerDrawScrolled(Layer *layers, const ScrollView *view, const Region *area)
+{
+  Region part = *area;
+  int lastRow = view->offset + view->height - 1;
+
+  if (part.topLeft.axes[0] < 0)
+    part.topLeft.axes[0] = 0;
+  if (part.botRight.axes[0] > screenWidth - 1)
+    part.botRight.axes[0] = screenWidth - 1;
+  if (part.topLeft.axes[1] < view->offset)
+    part.topLeft.axes[1] = view->offset;
+  if (part.botRight.axes[1] > lastRow)
+    part.botRight.axes[1] = lastRow;
+  if (part.topLeft.axes[0] > part.botRight.axes[0])
+    return;
+  lastRow = part.botRight.axes[1];
+  while (part.topLeft.axes[1] <= lastRow) { /* at most twice: band wraps once */
+    int memRow = scrollViewMemRow(view, part.topLeft.axes[1]);
+    int rows = view->top + view->height - memRow;
+    if (part.topLeft.axes[1] + rows - 1 < lastRow)
+      part.botRight.axes[1] = part.topLeft.axes[1] + rows - 1;
+    else
+      part.botRight.axes[1] = lastRow;
+    layerDrawRows(layers, &part, memRow - part.topLeft.axes[1]);
+    part.topLeft.axes[1] = part.botRight.axes[1] + 1;
+  }
+}
+
 void
 layerDraw(Layer *layers)
 {
-  int row, col;
-  for (row = 0; row < screenHeight; row++) {
-    lcd_setArea(0, row, screenWidth-1, row);
-    for (col = 0; col < screenWidth; col++) {
-      Vec2 pixelPos = {col, row};
-      u_int color = bgColor;
-      Layer *probeLayer;
-      for (probeLayer = layers; probeLayer; probeLayer = probeLayer->next) {
-	if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	  color = probeLayer->color;
-	  break; 
-	} /* if check */
-      } // for checking all layers at col, row
-      lcd_writeColor(color); 
-    } // for col
-  } // for row
+  Region screen = {{0, 0}, {screenWidth-1, screenHeight-1}};
+  layerDrawRegion(layers, &screen);
 } 
 
 
@@ -29,12 +55,21 @@ void
 layerGetBounds(const Layer *l, Region *bounds)
 {
   Region lastBounds, curBounds;
-  abShapeGetBounds(l->abShape, &l->posLast, &lastBounds);
-  abShapeGetBounds(l->abShape, &l->pos, &curBounds);
+  Vec2 at;
+  abShapeGetBounds(l->abShape, LAYER_VEC2(l->posLast, at), &lastBounds);
+  abShapeGetBounds(l->abShape, LAYER_VEC2(l->pos, at), &curBounds);
   regionUnion(bounds, &curBounds, &lastBounds);
   regionClipScreen(bounds);
 }
 
+void
+layerSetPosFx(Layer *l, const Vec2Fx *pos)
+{
+  Vec2 rounded;
+  vec2FxRound(&rounded, pos);
+  LAYER_VEC_SET(l->posNext, rounded);
+}
+
 void
 layerInit(Layer *layer)
 {
@@ -42,3 +77,114 @@ layerInit(Layer *layer)
     layer->posLast = layer->posNext = layer->pos;
 }
 
+/** The static layer, or bgColor, at pixel (private) */
+static void
+layerBakePixel(Layer *layers, const Vec2 *pixel, LayerRun *run)
+{
+  u_char depth = 0;
+  Layer *l;
+  Vec2 at;
+  for (l = layers; l && depth < LAYER_MAX_DEPTH; l = l->next, depth++)
+    if ((l->flags & LAYER_STATIC)
+	&& abShapeCheck(l->abShape, LAYER_VEC2(l->pos, at), pixel)) {
+      run->color = LAYER_COLOR(l);
+      run->depth = depth;
+      return;
+    }
+  run->color = bgColor;
+  run->depth = 255;
+}
+
+/** The run of row's static layers from *col, moving *col past it
+ *  (private)
+ *
+ *  \return 0 at the end of the row
+ */
+static int
+layerBakeRun(Layer *layers, int row, int *col, LayerRun *run)
+{
+  Vec2 pixel = {*col, row};
+  LayerRun next;
+  if (*col >= screenWidth)
+    return 0;
+  layerBakePixel(layers, &pixel, run);
+  run->length = 0;
+  do {
+    run->length++;
+    if (++pixel.axes[0] >= screenWidth)
+      break;
+    layerBakePixel(layers, &pixel, &next);
+  } while (next.color == run->color && next.depth == run->depth);
+  *col = pixel.axes[0];
+  return 1;
+}
+
+/** Are row's runs the ones bg holds from first? (private) */
+static int
+layerBakeSame(Layer *layers, const LayerBackground *bg, int row, u_char first)
+{
+  const LayerRun *stored = &bg->runs[first], *end = &bg->runs[bg->numRuns];
+  LayerRun run;
+  int col = 0;
+  for (; layerBakeRun(layers, row, &col, &run); stored++)
+    if (stored == end || run.color != stored->color
+	|| run.length != stored->length || run.depth != stored->depth)
+      return 0;
+  return 1;
+}
+
+/** Append row's runs to bg (private)
+ *
+ *  \return 0 if bg is full
+ */
+static int
+layerBakeRow(Layer *layers, LayerBackground *bg, int row)
+{
+  LayerRun run;
+  int col = 0;
+  while (layerBakeRun(layers, row, &col, &run)) {
+    if (bg->numRuns >= bg->maxRuns)
+      return 0;
+    bg->runs[bg->numRuns++] = run;
+  }
+  return 1;
+}
+
+/* Rows are compared with the runs already baked as they are scanned,
+ * so bg needs room for the runs it keeps and no more.
+ */
+int
+layerBakeStatic(Layer *layers, LayerBackground *bg)
+{
+  int row;
+  Layer *l;
+  layerBackground = 0;		/* draw static layers until bg is done */
+  bg->numRuns = 0;
+  bg->numBands = 0;
+  for (row = 0; row < screenHeight; row++) {
+    LayerBand *band;
+    u_char b;
+    if (bg->numBands
+	&& layerBakeSame(layers, bg, row, bg->bands[bg->numBands-1].firstRun))
+      continue;			/* extends the band above */
+    if (bg->numBands >= bg->maxBands)
+      return 0;
+    band = &bg->bands[bg->numBands++];
+    band->top = row;
+    for (b = 0; b + 1 < bg->numBands; b++)
+      if (layerBakeSame(layers, bg, row, bg->bands[b].firstRun))
+	break;
+    if (b + 1 < bg->numBands)
+      band->firstRun = bg->bands[b].firstRun; /* share an earlier band's runs */
+    else {
+      band->firstRun = bg->numRuns;
+      if (!layerBakeRow(layers, bg, row))
+	return 0;
+    }
+  }
+  for (l = layers; l; l = l->next)
+    if (l->flags & LAYER_STATIC)
+      l->flags |= LAYER_BAKED;
+  layerBackground = bg;
+  return 1;
+}
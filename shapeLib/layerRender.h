@@ -0,0 +1,269 @@
+/** \file layerRender.h
+ *  \brief The layer renderer as a template, specialized at compile time
+ *
+ *  Including this defines
+ *
+ *    static void LAYER_RENDER_NAME(Layer *layers, const Region *area, int rowDelta)
+ *
+ *  which renders layers within area, writing row r of it to LCD row
+ *  r + rowDelta.  layer.c builds the generic one behind layerDrawRegion,
+ *  which reaches every shape through AbShape's function pointers.
+ *
+ *  A program whose layers use a known set of shape types can build
+ *  its own, in which those types' bounds, spans and checks are inlined:
+ *
+ *    #define LAYER_RENDER_NAME sceneDrawRows
+ *    #define LAYER_RENDER_SHAPES(X) X(AbRect, abRect) X(AbCircle, abCircle)
+ *    #include <layerRender.h>
+ *
+ *  X(Type, prefix) needs prefixGetBounds, prefixCheck and prefixSpans
+ *  and their Inline bodies (shape.h, abCircle.h).  A layer is matched
+ *  to its type by comparing AbShape's function pointers, so layers of
+ *  unlisted types still render, through the pointers.
+ *
+ *  Defining LAYER_RENDER_ROW_PIXELS gives it two row buffers of that
+ *  many pixels (2 bytes each), on its stack.  Rows of areas no wider
+ *  are composed into one while lcd_pushPixelsAsync sends the other
+ *  under the TX interrupt, and the last row is flushed before it
+ *  returns; wider rows are sent run by run as usual.  It has no effect
+ *  in 12 bit color mode.  The macros are undefined at the
+ *  end, so this may be included again.
+ */
+
+#ifndef layerRender_included
+#define layerRender_included
+
+#include "lcdutils.h"
+#include "shape.h"
+
+typedef void (*LayerRenderBoundsFn)(const AbShape *, const Vec2 *, Region *);
+typedef int (*LayerRenderCheckFn)(const AbShape *, const Vec2 *, const Vec2 *);
+typedef int (*LayerRenderSpansFn)(const AbShape *, const Vec2 *, int, Span *);
+
+#define LAYER_RENDER_CAT_(a, b) a##b
+#define LAYER_RENDER_CAT(a, b) LAYER_RENDER_CAT_(a, b)
+/** Name of a helper private to this LAYER_RENDER_NAME */
+#define LAYER_RENDER_FN(what) LAYER_RENDER_CAT(LAYER_RENDER_NAME, what)
+
+#define LAYER_RENDER_BOUNDS_CASE(Type, prefix)				\
+  if (shape->getBounds == (LayerRenderBoundsFn)prefix##GetBounds) {	\
+    prefix##GetBoundsInline((const Type *)shape, centerPos, bounds);	\
+    return;								\
+  }
+#define LAYER_RENDER_CHECK_CASE(Type, prefix)				\
+  if (shape->check == (LayerRenderCheckFn)prefix##Check)		\
+    return prefix##CheckInline((const Type *)shape, centerPos, pixel);
+#define LAYER_RENDER_SPANS_CASE(Type, prefix)				\
+  if (shape->spans == (LayerRenderSpansFn)prefix##Spans)		\
+    return prefix##SpansInline((const Type *)shape, centerPos, row, spans);
+
+/** Insert l into the scanNext list at *list, keeping it sorted by
+ *  scanTop (stable) or by depth
+ */
+static void
+scanInsert(Layer **list, Layer *l, u_char byDepth)
+{
+  for (; *list; list = &(*list)->scanNext)
+    if (byDepth ? (*list)->depth > l->depth : (*list)->scanTop > l->scanTop)
+      break;
+  l->scanNext = *list;
+  *list = l;
+}
+
+#endif /* layerRender_included */
+
+#ifndef LAYER_RENDER_NAME
+#error define LAYER_RENDER_NAME before including layerRender.h
+#endif
+
+#ifndef LAYER_RENDER_SHAPES
+#define LAYER_RENDER_SHAPES(X)
+#endif
+
+#if defined(LAYER_RENDER_ROW_PIXELS) && LCD_COLOR_BITS != 16
+#undef LAYER_RENDER_ROW_PIXELS	/* 12 bit pixels are not sent async */
+#endif
+
+static inline void
+LAYER_RENDER_FN(Bounds)(const AbShape *shape, const Vec2 *centerPos, Region *bounds)
+{
+  LAYER_RENDER_SHAPES(LAYER_RENDER_BOUNDS_CASE)
+  abShapeGetBounds(shape, centerPos, bounds);
+}
+
+static inline int
+LAYER_RENDER_FN(Check)(const AbShape *shape, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  LAYER_RENDER_SHAPES(LAYER_RENDER_CHECK_CASE)
+  return abShapeCheck(shape, centerPos, pixel);
+}
+
+static inline int
+LAYER_RENDER_FN(Spans)(const AbShape *shape, const Vec2 *centerPos, int row, Span *spans)
+{
+  LAYER_RENDER_SHAPES(LAYER_RENDER_SPANS_CASE)
+  return abShapeSpans(shape, centerPos, row, spans);
+}
+
+/** Render area, writing row r of it to LCD row r + rowDelta
+ *
+ *  Each layer's bounds are computed once.  Layers that touch area wait
+ *  in a list sorted by top row and move to the active list, kept in
+ *  front-to-back order, when the row reaches them; they leave it
+ *  after their bottom row.  Only active layers are consulted.
+ *
+ *  Each row is cut into runs of one color: at col, the frontmost layer
+ *  with a span covering col owns the run, which ends where that span
+ *  does or where a span of a layer in front of it begins.  Layers
+ *  without spans are probed with their check and limit runs to one
+ *  pixel while they are in front.
+ *
+ *  Layers are culled with abShapeProps: a layer within the largest
+ *  solid layer in front of it, or whose hollow interior holds its part
+ *  of area, is never admitted.
+ *
+ *  With a layerBackground, baked layers are skipped: a run's color
+ *  defaults to the background run under col, which also ends it, and
+ *  only layers in front of that run's layer are consulted.
+ */
+static void
+LAYER_RENDER_NAME(Layer *layers, const Region *area, int rowDelta)
+{
+  int row, col, colEnd = area->botRight.axes[0];
+  Layer *pending = 0, *active = 0, *l, **link;
+  u_char depth = 0, band = 0;
+  const LayerBackground *bg = layerBackground;
+  Region occluder;		/* largest solid layer so far, within area */
+  u_int occluderArea = 0;
+#ifdef LAYER_RENDER_ROW_PIXELS
+  u_int rows[2][LAYER_RENDER_ROW_PIXELS]; /* one is filled while the other is sent */
+  u_int *rowPixels = 0, *fill = 0; /* row buffer, 0 to send runs at once */
+  u_char rowFree = 0;		/* not the one last sent */
+  u_char buffered = colEnd - area->topLeft.axes[0] < LAYER_RENDER_ROW_PIXELS;
+#endif
+
+  if (area->topLeft.axes[0] < 0 || colEnd >= screenWidth)
+    bg = 0;			/* runs only cover the screen */
+  for (l = layers; l && depth < LAYER_MAX_DEPTH; l = l->next, depth++) {
+    Region bounds, interior;
+    Vec2 at;
+    const Vec2 *pos = LAYER_VEC2(l->pos, at);
+    u_char props;
+    if (bg && (l->flags & LAYER_BAKED))
+      continue;			/* drawn from bg */
+    LAYER_RENDER_FN(Bounds)(l->abShape, pos, &bounds);
+    regionIntersect(&bounds, &bounds, area);
+    if (!regionArea(&bounds))
+      continue;			/* misses area */
+    if (occluderArea && regionContains(&occluder, &bounds))
+      continue;			/* hidden behind a solid layer */
+    props = abShapeProps(l->abShape, pos, &interior);
+    if ((props & SHAPE_HOLLOW) && regionContains(&interior, &bounds))
+      continue;			/* area lies in its hole */
+    if ((props & SHAPE_SOLID) && regionArea(&bounds) > occluderArea) {
+      occluder = bounds;
+      occluderArea = regionArea(&bounds);
+    }
+    l->scanTop = bounds.topLeft.axes[1];
+    l->scanBottom = bounds.botRight.axes[1];
+    l->depth = depth;
+    scanInsert(&pending, l, 0);
+  }
+
+  lcd_setArea(area->topLeft.axes[0], area->topLeft.axes[1] + rowDelta,
+	      area->botRight.axes[0], area->botRight.axes[1] + rowDelta);
+  for (row = area->topLeft.axes[1]; row <= area->botRight.axes[1]; row++) {
+    const LayerRun *bgRun = 0;
+    int bgRunEnd = -1;		/* last column of bgRun */
+    for (link = &active; (l = *link); ) /* retire layers above row */
+      if (l->scanBottom < row)
+	*link = l->scanNext;
+      else
+	link = &l->scanNext;
+    while (pending && pending->scanTop <= row) { /* admit layers reaching row */
+      l = pending;
+      pending = l->scanNext;
+      scanInsert(&active, l, 1);
+    }
+#ifdef LAYER_RENDER_ROW_PIXELS
+    if (buffered)
+      fill = rowPixels = rows[rowFree];
+#endif
+    if (bg && row >= 0 && row < screenHeight) {
+      while (band + 1 < bg->numBands && bg->bands[band+1].top <= row)
+	band++;
+      bgRun = &bg->runs[bg->bands[band].firstRun];
+      bgRunEnd = bgRun->length - 1;
+    }
+    for (col = area->topLeft.axes[0]; col <= colEnd; ) {
+      int runEnd = colEnd;
+      u_int color = bgColor;
+      u_char frontDepth = 255;	/* layers behind this one are hidden */
+      Layer *probeLayer;
+      if (bgRun) {
+	while (bgRunEnd < col) {
+	  bgRun++;
+	  bgRunEnd += bgRun->length;
+	}
+	color = bgRun->color;
+	frontDepth = bgRun->depth;
+	if (bgRunEnd < runEnd)
+	  runEnd = bgRunEnd;
+      }
+      for (probeLayer = active; probeLayer; probeLayer = probeLayer->scanNext) {
+	Span spans[SHAPE_MAX_SPANS];
+	Vec2 at;
+	const Vec2 *pos = LAYER_VEC2(probeLayer->pos, at);
+	int n, i;
+	if (probeLayer->depth > frontDepth)
+	  break;		/* behind the background run's layer */
+	n = LAYER_RENDER_FN(Spans)(probeLayer->abShape, pos, row, spans);
+	if (n < 0) {		/* no spans: probe this pixel alone */
+	  Vec2 pixelPos = {col, row};
+	  runEnd = col;
+	  if (LAYER_RENDER_FN(Check)(probeLayer->abShape, pos, &pixelPos)) {
+	    color = LAYER_COLOR(probeLayer);
+	    break;
+	  }
+	  continue;
+	}
+	for (i = 0; i < n; i++) {
+	  if (spans[i].start > col) { /* may cover pixels later in the run */
+	    if (spans[i].start <= runEnd)
+	      runEnd = spans[i].start - 1;
+	  } else if (spans[i].end >= col)
+	    break;
+	}
+	if (i < n) {		/* covers col */
+	  color = LAYER_COLOR(probeLayer);
+	  if (spans[i].end < runEnd)
+	    runEnd = spans[i].end;
+	  break;
+	}
+      } // for checking active layers at col, row
+#ifdef LAYER_RENDER_ROW_PIXELS
+      if (rowPixels) {
+	int n = runEnd - col + 1;
+	while (n--)
+	  *fill++ = color;
+      } else
+#endif
+	lcd_fillRun(color, runEnd - col + 1);
+      col = runEnd + 1;
+    } // for run
+#ifdef LAYER_RENDER_ROW_PIXELS
+    if (rowPixels) {
+      lcd_pushPixelsAsync(rowPixels, fill - rowPixels);
+      rowFree ^= 1;
+    }
+#endif
+  } // for row
+#ifdef LAYER_RENDER_ROW_PIXELS
+  if (rowPixels)
+    lcd_flush();		/* rows go with this frame */
+#endif
+}
+
+#undef LAYER_RENDER_NAME
+#undef LAYER_RENDER_SHAPES
+#undef LAYER_RENDER_ROW_PIXELS
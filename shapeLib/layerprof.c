@@ -0,0 +1,139 @@
+/** \file layerprof.c
+ *  \brief Host profiler for the layer renderer.
+ *
+ *  Builds a pong-like scene (arena outline, two paddles and a ball),
+ *  paints it with layerDraw, then moves the ball for a number of frames
+ *  with the paddles tracking it, redrawing only what the moving layers
+ *  changed through a DirtyList the way the game's DoRenderLayers does.
+ *  Bus traffic per frame comes from the ST7735 emulator; the final
+ *  frame is written to layerprof.ppm.  The arena is static and baked
+ *  into a LayerBackground unless bake is 0.
+ *
+ *  usage: layerprof [frames [spiHz [bake]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "shape.h"
+#include "st7735emu.h"
+
+u_int bgColor = COLOR_BLACK;
+
+const AbRect rectBall = {abRectGetBounds, abRectCheck, abRectSpans, {2,2}};
+const AbRect rectPaddle = {abRectGetBounds, abRectCheck, abRectSpans, {12,1}};
+const AbRectOutline outlineField = {
+  abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineSpans,
+  {screenWidth/2 - 10, screenHeight/2 - 1}
+};
+
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {COLOR_WHITE}; /**< LAYER_INK indices */
+#endif
+
+Layer layerField = {
+  (AbShape *)&outlineField,
+  {screenWidth/2, screenHeight/2},
+  {0,0}, {0,0},
+  LAYER_INK(0, COLOR_WHITE),
+  0,
+  LAYER_STATIC
+};
+Layer layerPaddleLeft = {
+  (AbShape *)&rectPaddle,
+  {screenWidth/2, 10},
+  {0,0}, {0,0},
+  LAYER_INK(0, COLOR_WHITE),
+  &layerField
+};
+Layer layerPaddleRight = {
+  (AbShape *)&rectPaddle,
+  {screenWidth/2, screenHeight-10},
+  {0,0}, {0,0},
+  LAYER_INK(0, COLOR_WHITE),
+  &layerPaddleLeft
+};
+Layer layerBall = {
+  (AbShape *)&rectBall,
+  {screenWidth/2, screenHeight/2},
+  {0,0}, {0,0},
+  LAYER_INK(0, COLOR_WHITE),
+  &layerPaddleRight
+};
+
+/** Moving layers, as the game's transform list */
+static Layer *movers[] = {&layerBall, &layerPaddleRight, &layerPaddleLeft};
+#define NUM_MOVERS (sizeof(movers) / sizeof(movers[0]))
+
+static DirtyList dirty;
+static LayerRun backgroundRuns[16];
+static LayerBand backgroundBands[6];
+static LayerBackground background = {backgroundRuns, backgroundBands, 16, 6};
+
+int
+main(int argc, char **argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 60;
+  int frame, i;
+  Vec2 velocity = {1, -3};
+  unsigned long totalMicros = 0, worstMicros = 0;
+  unsigned long totalAdded = 0, totalDrawn = 0;
+
+  if (argc > 2)
+    st7735_setSpiClock(strtoul(argv[2], 0, 0));
+
+  lcd_init();
+  layerInit(&layerBall);
+  if ((argc <= 3 || atoi(argv[3])) && !layerBakeStatic(&layerBall, &background))
+    printf("arena too complex to bake\n");
+  dirtyInit(&dirty);
+
+  st7735_resetStats();
+  layerDraw(&layerBall);
+  lcd_flush();
+  st7735_printStats(stdout, "layerDraw");
+
+  for (frame = 0; frame < frames; frame++) {
+    Vec2 ball, next, at;
+    ball = *LAYER_VEC2(layerBall.posNext, at);
+    vec2Add(&next, &ball, &velocity);
+    if (next.axes[0] < 15 || next.axes[0] > screenWidth - 15)
+      velocity.axes[0] = -velocity.axes[0];
+    if (next.axes[1] < 11 || next.axes[1] > screenHeight - 11)
+      velocity.axes[1] = -velocity.axes[1]; /* off a paddle */
+    vec2Add(&next, &ball, &velocity);
+    LAYER_VEC_SET(layerBall.posNext, next);
+    layerPaddleLeft.posNext.axes[0] = layerBall.posNext.axes[0];
+    layerPaddleRight.posNext.axes[0] = layerBall.posNext.axes[0];
+
+    st7735_resetStats();
+    for (i = 0; i < NUM_MOVERS; i++) {
+      Layer *l = movers[i];
+      l->posLast = l->pos;
+      l->pos = l->posNext;
+    }
+    for (i = 0; i < NUM_MOVERS; i++)
+      dirtyAddLayer(&dirty, movers[i]);
+    dirtyFlush(&dirty, &layerBall);
+    lcd_flush();		/* frame complete on the glass */
+    totalAdded += dirty.pixelsAdded;
+    totalDrawn += dirty.pixelsDrawn;
+    totalMicros += st7735_busMicros();
+    if (st7735_busMicros() > worstMicros)
+      worstMicros = st7735_busMicros();
+    if (frame < 3 || frame == frames - 1) {
+      char label[32];
+      sprintf(label, "frame %d", frame);
+      st7735_printStats(stdout, label);
+      printf("  %u dirty pixels, %u drawn\n", dirty.pixelsAdded, dirty.pixelsDrawn);
+    }
+  }
+  if (frames) {
+    printf("%d frames: mean %lu us, worst %lu us on the bus\n",
+	   frames, totalMicros / frames, worstMicros);
+    printf("%lu dirty pixels, %lu drawn after coalescing\n",
+	   totalAdded, totalDrawn);
+  }
+  return st7735_writePPM("layerprof.ppm");
+}
@@ -0,0 +1,135 @@
+/** \file makeBitmap.c
+ *  \brief Converts a PBM image into an AbBitmap
+ *
+ *  usage: makeBitmap image.pbm name
+ *
+ *  Reads a plain (P1) or binary (P4) PBM image and writes name.c, which
+ *  defines "const AbBitmap name", and name.h, which declares it.  Black
+ *  (1) pixels are the ones the shape covers.  Rows are stored as in a
+ *  P4 file: (width + 7) / 8 bytes, leftmost pixel in the top bit, with
+ *  the padding bits cleared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+#define MAX_EDGE 160		/* longest screen edge */
+#define MAX_STRIDE ((MAX_EDGE + 7) / 8)
+
+static unsigned char bits[MAX_EDGE][MAX_STRIDE];
+
+/* next character that is not part of a comment */
+static int
+nextChar(FILE *fp)
+{
+  int c = getc(fp);
+  if (c == '#')
+    while (c != '\n' && c != EOF)
+      c = getc(fp);
+  return c;
+}
+
+/* next decimal number in the header or a P1 body, or -1 */
+static int
+nextNumber(FILE *fp, int digits)
+{
+  int c, n = 0, seen = 0;
+  do
+    c = nextChar(fp);
+  while (isspace(c));
+  while (isdigit(c)) {
+    n = n * 10 + c - '0';
+    seen++;
+    if (seen == digits)		/* P1 bits may be written without spaces */
+      break;
+    c = nextChar(fp);
+  }
+  return seen ? n : -1;
+}
+
+static void
+fail(const char *image, const char *why)
+{
+  fprintf(stderr, "makeBitmap: %s: %s\n", image, why);
+  exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+  const char *image, *name;
+  char fileName[256];
+  FILE *in, *fp;
+  int format, width, height, stride, row, col;
+
+  if (argc != 3) {
+    fprintf(stderr, "usage: makeBitmap image.pbm name\n");
+    return 1;
+  }
+  image = argv[1];
+  name = argv[2];
+  if (!(in = fopen(image, "rb")))
+    fail(image, "cannot open");
+  if (getc(in) != 'P')
+    fail(image, "not a PBM image");
+  format = getc(in);
+  if (format != '1' && format != '4')
+    fail(image, "not a P1 or P4 PBM image");
+  width = nextNumber(in, 0);
+  height = nextNumber(in, 0);
+  if (width < 1 || height < 1 || width > MAX_EDGE || height > MAX_EDGE)
+    fail(image, "size must be 1 to 160 pixels each way");
+  stride = (width + 7) / 8;
+
+  if (format == '4') {		/* one whitespace character, then the rows */
+    for (row = 0; row < height; row++)
+      if (fread(bits[row], 1, stride, in) != stride)
+	fail(image, "truncated");
+  } else {
+    for (row = 0; row < height; row++)
+      for (col = 0; col < width; col++) {
+	int bit = nextNumber(in, 1);
+	if (bit < 0)
+	  fail(image, "truncated");
+	if (bit)
+	  bits[row][col >> 3] |= 0x80 >> (col & 7);
+      }
+  }
+  fclose(in);
+  if (width & 7)		/* clear padding so whole bytes can be skipped */
+    for (row = 0; row < height; row++)
+      bits[row][stride - 1] &= 0xff << (8 - (width & 7));
+
+  snprintf(fileName, sizeof fileName, "%s.h", name);
+  if (!(fp = fopen(fileName, "w")))
+    fail(fileName, "cannot create");
+  fprintf(fp, "// Automatically generated by makeBitmap from %s\n", image);
+  fprintf(fp, "#ifndef %s_included\n#define %s_included\n\n", name, name);
+  fprintf(fp, "#include \"shape.h\"\n\n");
+  fprintf(fp, "extern const AbBitmap %s;\t/* %d x %d */\n\n", name, width, height);
+  fprintf(fp, "#endif // included\n");
+  fclose(fp);
+
+  snprintf(fileName, sizeof fileName, "%s.c", name);
+  if (!(fp = fopen(fileName, "w")))
+    fail(fileName, "cannot create");
+  fprintf(fp, "// Automatically generated by makeBitmap from %s\n", image);
+  fprintf(fp, "#include \"%s.h\"\n\n", name);
+  fprintf(fp, "static const u_char %sBits[%d] = {\n", name, stride * height);
+  for (row = 0; row < height; row++) {
+    fprintf(fp, "  ");
+    for (col = 0; col < stride; col++)
+      fprintf(fp, "0x%02x, ", bits[row][col]);
+    fprintf(fp, "// ");
+    for (col = 0; col < width; col++)
+      putc(bits[row][col >> 3] & (0x80 >> (col & 7)) ? '#' : '.', fp);
+    fprintf(fp, "\n");
+  }
+  fprintf(fp, "};\n\n");
+  fprintf(fp, "const AbBitmap %s = {\n", name);
+  fprintf(fp, "  abBitmapGetBounds, abBitmapCheck, abBitmapSpans,\n");
+  fprintf(fp, "  {%d, %d},\n  %sBits\n};\n", width, height, name);
+  fclose(fp);
+  return 0;
+}
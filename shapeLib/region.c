@@ -11,7 +11,86 @@ regionUnion(Region *rUnion, const Region *r1, const Region *r2)
 // Trims extent of region to screen bounds
 void regionClipScreen(Region *r)
 {
+  Vec2 screenLast;		/* bottom-right pixel */
+  vec2Sub(&screenLast, &screenSize, &vec2Unit);
   vec2Max(&r->topLeft, &r->topLeft, &vec2Zero);
-  vec2Min(&r->botRight, &r->botRight, &screenSize);
+  vec2Min(&r->botRight, &r->botRight, &screenLast);
+}
+
+// pixels in region (inclusive of botRight), 0 if empty
+u_int
+regionArea(const Region *r)
+{
+  int cols = r->botRight.axes[0] - r->topLeft.axes[0] + 1;
+  int rows = r->botRight.axes[1] - r->topLeft.axes[1] + 1;
+  if (cols <= 0 || rows <= 0)
+    return 0;
+  return (u_int)cols * rows;
+}
+
+// true if the regions share a pixel
+int
+regionOverlaps(const Region *r1, const Region *r2)
+{
+  int axis;
+  for (axis = 0; axis < 2; axis++)
+    if (r1->botRight.axes[axis] < r2->topLeft.axes[axis]
+	|| r2->botRight.axes[axis] < r1->topLeft.axes[axis])
+      return 0;
+  return 1;
+}
+
+// true if every pixel of inner is in outer
+int
+regionContains(const Region *outer, const Region *inner)
+{
+  int axis;
+  for (axis = 0; axis < 2; axis++)
+    if (inner->topLeft.axes[axis] < outer->topLeft.axes[axis]
+	|| inner->botRight.axes[axis] > outer->botRight.axes[axis])
+      return 0;
+  return 1;
+}
+
+// the pixels in both regions; empty (see regionArea) if none
+void
+regionIntersect(Region *rIntersect, const Region *r1, const Region *r2)
+{
+  vec2Max(&rIntersect->topLeft, &r1->topLeft, &r2->topLeft);
+  vec2Min(&rIntersect->botRight, &r1->botRight, &r2->botRight);
+}
+
+// cut r into the bands above and below hole and the pieces beside it
+int
+regionSubtract(Region pieces[4], const Region *r, const Region *hole)
+{
+  int n = 0, top = r->topLeft.axes[1], bot = r->botRight.axes[1];
+  if (!regionOverlaps(r, hole)) {
+    pieces[0] = *r;
+    return 1;
+  }
+  if (hole->topLeft.axes[1] > top) { /* band above */
+    top = hole->topLeft.axes[1];
+    pieces[n] = *r;
+    pieces[n++].botRight.axes[1] = top - 1;
+  }
+  if (hole->botRight.axes[1] < bot) { /* band below */
+    bot = hole->botRight.axes[1];
+    pieces[n] = *r;
+    pieces[n++].topLeft.axes[1] = bot + 1;
+  }
+  if (hole->topLeft.axes[0] > r->topLeft.axes[0]) { /* left, between the bands */
+    pieces[n].topLeft.axes[0] = r->topLeft.axes[0];
+    pieces[n].botRight.axes[0] = hole->topLeft.axes[0] - 1;
+    pieces[n].topLeft.axes[1] = top;
+    pieces[n++].botRight.axes[1] = bot;
+  }
+  if (hole->botRight.axes[0] < r->botRight.axes[0]) { /* right */
+    pieces[n].topLeft.axes[0] = hole->botRight.axes[0] + 1;
+    pieces[n].botRight.axes[0] = r->botRight.axes[0];
+    pieces[n].topLeft.axes[1] = top;
+    pieces[n++].botRight.axes[1] = bot;
+  }
+  return n;
 }
 
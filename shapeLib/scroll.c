@@ -0,0 +1,42 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+void
+scrollViewInit(ScrollView *view, u_char top, u_char height)
+{
+  view->top = top;
+  view->height = height;
+  view->offset = 0;
+  lcd_setScrollArea(top, height);
+  lcd_setScrollStart(top);
+}
+
+int
+scrollViewMemRow(const ScrollView *view, int logicalRow)
+{
+  int r = logicalRow % view->height;
+  if (r < 0)
+    r += view->height;
+  return view->top + r;
+}
+
+void
+scrollViewSet(ScrollView *view, int offset, Region *exposed)
+{
+  int delta = offset - view->offset;
+  int first = offset, last = offset + view->height - 1; /* whole band */
+
+  if (delta > 0 && delta < view->height)
+    first = view->offset + view->height; /* rows entering at the bottom */
+  else if (delta < 0 && -delta < view->height)
+    last = view->offset - 1;	/* rows entering at the top */
+  else if (!delta)
+    last = first - 1;		/* nothing */
+  exposed->topLeft.axes[0] = 0;
+  exposed->botRight.axes[0] = screenWidth - 1;
+  exposed->topLeft.axes[1] = first;
+  exposed->botRight.axes[1] = last;
+
+  view->offset = offset;
+  lcd_setScrollStart(scrollViewMemRow(view, offset));
+}
@@ -22,3 +22,29 @@ abShapeCheck(const AbShape *s, const Vec2 *centerPos, const Vec2 *pixelLoc)
   return (*s->check)(s, centerPos, pixelLoc);
 }
 
+int
+abShapeSpans(const AbShape *s, const Vec2 *centerPos, int row, Span *spans)
+{
+  if (!s->spans)
+    return -1;
+  return (*s->spans)(s, centerPos, row, spans);
+}
+
+typedef int (*AbShapeCheckFn)(const AbShape *, const Vec2 *, const Vec2 *);
+
+// known from the check function, which defines what a shape covers
+u_char
+abShapeProps(const AbShape *s, const Vec2 *centerPos, Region *interior)
+{
+  if (s->check == (AbShapeCheckFn)abRectCheck)
+    return SHAPE_SOLID;
+  if (s->check == (AbShapeCheckFn)abRectOutlineCheck) {
+    abShapeGetBounds(s, centerPos, interior); /* all but the edges */
+    interior->topLeft.axes[0]++;
+    interior->topLeft.axes[1]++;
+    interior->botRight.axes[0]--;
+    interior->botRight.axes[1]--;
+    return SHAPE_HOLLOW;
+  }
+  return 0;
+}
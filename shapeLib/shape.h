@@ -48,6 +48,45 @@ void vec2Sub(Vec2 *result, const Vec2 *a1, const Vec2 *a2);
  */ 
 void vec2Abs(Vec2 *vec);
 
+/** Fixed-point coordinates for sub-pixel motion
+ *
+ *  Q10.6 in an int: steps of 1/64 pixel from -512 to just under 512,
+ *  which covers the screen (Q8.8 would stop at 127).  Physics keeps
+ *  positions and velocities in Vec2Fx; they are rounded to pixels
+ *  only when a layer is placed (layerSetPosFx).
+ */
+#define FX_FRAC_BITS 6
+#define FX_ONE (1 << FX_FRAC_BITS)
+
+/** Pixels to fixed point; constant fractions fold at compile time,
+ *  e.g. FX(1.5) */
+#define FX(pixels) ((int)((pixels) * FX_ONE))
+
+/** Fixed point to the nearest pixel (halves round up) */
+#define FX_ROUND(fx) (((fx) + FX_ONE / 2) >> FX_FRAC_BITS)
+
+typedef struct {
+  int axes[2];			/* Q10.6 */
+} Vec2Fx;
+
+/** Vector sum: result = v1 + v2
+ */
+void vec2FxAdd(Vec2Fx *result, const Vec2Fx *v1, const Vec2Fx *v2);
+
+/** Convert pixels to fixed point
+ *
+ *  \param fx (out) The fixed-point vector
+ *  \param v (in) The pixel vector
+ */
+void vec2FxFromVec2(Vec2Fx *fx, const Vec2 *v);
+
+/** Round fixed point to the nearest pixels
+ *
+ *  \param v (out) The pixel vector
+ *  \param fx (in) The fixed-point vector
+ */
+void vec2FxRound(Vec2 *v, const Vec2Fx *fx);
+
 /** Specifies a rectangular region
  */
 typedef struct {
@@ -58,10 +97,35 @@ typedef struct {
  */
 void regionUnion(Region *rUnion, const Region *r1, const Region *r2);
 
-/** Clip region within screen bounds
+/** Clip region within screen bounds (botRight inclusive)
  */
 void regionClipScreen(Region *region);
 
+/** Number of pixels in region, inclusive of botRight; 0 if empty
+ */
+u_int regionArea(const Region *region);
+
+/** True if the two regions share at least one pixel
+ */
+int regionOverlaps(const Region *r1, const Region *r2);
+
+/** True if every pixel of inner is in outer
+ */
+int regionContains(const Region *outer, const Region *inner);
+
+/** Computes the region shared by two regions (empty if none)
+ */
+void regionIntersect(Region *rIntersect, const Region *r1, const Region *r2);
+
+/** Cover the part of r outside hole with up to 4 disjoint regions
+ *
+ *  \param pieces (out) The regions
+ *  \param r (in) The region to cut
+ *  \param hole (in) The region to remove
+ *  \return The number of pieces (r itself if they do not overlap)
+ */
+int regionSubtract(Region pieces[4], const Region *r, const Region *hole);
+
 /** This function initializes the screen
  *  vectors that are used by shapes
  *
@@ -69,20 +133,36 @@ void regionClipScreen(Region *region);
  */
 void shapeInit();
 
+/** A horizontal run of pixels within one row: columns start..end
+ *  (inclusive)
+ */
+typedef struct {
+  int start, end;
+} Span;
+
+/** Most spans any AbShape returns for a single row */
+#define SHAPE_MAX_SPANS 2
+
 /** Effectively a base class for Abstract Shapes
  *  
  *  Abstract Shapes have a shape but no position or color.
- *  The first two fields MUST BE pointers to
+ *  The first three fields MUST BE pointers to
  *
  *  getBounds: A function that computes the bounding box for the AbShape
  *  when rendered at coordinate centerPos
  * 
  *  check: A function that determines if the AbShape contains pixelLoc when 
  *  rendered at centerPos
+ *
+ *  spans: A function that stores the runs of pixels the AbShape covers
+ *  in a row, left to right, into spans (at most SHAPE_MAX_SPANS) and
+ *  returns their number, or returns -1 if it cannot.  Optional: it may
+ *  be 0, in which case renderers use check.
  */
 typedef struct AbShape_s {		/* base type for all abstrct shapes */
   void (*getBounds)(const struct AbShape_s *shape, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbShape_s *shape, const Vec2 *centerPos, const Vec2 *pixelLoc);
+  int (*spans)(const struct AbShape_s *shape, const Vec2 *centerPos, int row, Span *spans);
 } AbShape;
 
 /** Computes bounding box of abShape in screen coordinates 
@@ -102,6 +182,36 @@ void abShapeGetBounds(const AbShape *s, const Vec2 *centerPos, Region *bounds);
  */
 int abShapeCheck(const AbShape *shape, const Vec2 *centerPos, const Vec2 *pixelLoc);
 
+/** Compute the runs of pixels in row covered by the abShape centered
+ *  at centerPos
+ *
+ *  \param shape (in) The abstract shape
+ *  \param centerPos (in) The Vec2 specifying the center position of the shape
+ *  \param row (in) The row
+ *  \param spans (out) Up to SHAPE_MAX_SPANS spans, left to right
+ *  \return The number of spans, or -1 if the shape has no spans
+ *  function (use abShapeCheck)
+ */
+int abShapeSpans(const AbShape *shape, const Vec2 *centerPos, int row, Span *spans);
+
+/** Properties that let renderers skip a shape (abShapeProps) */
+#define SHAPE_SOLID 1		/**< covers every pixel of its bounds */
+#define SHAPE_HOLLOW 2		/**< covers no pixel of its interior */
+
+/** What is known about the pixels the abShape centered at centerPos
+ *  covers, beyond its bounds
+ *
+ *  Renderers use this to skip layers hidden behind a solid one and
+ *  layers whose interior holds the whole area being drawn.  Shapes
+ *  that advertise nothing return 0 and are always probed.
+ *
+ *  \param shape (in) The abstract shape
+ *  \param centerPos (in) The Vec2 specifying the center position of the shape
+ *  \param interior (out) For SHAPE_HOLLOW, a region it does not cover
+ *  \return SHAPE_SOLID, SHAPE_HOLLOW or 0
+ */
+u_char abShapeProps(const AbShape *shape, const Vec2 *centerPos, Region *interior);
+
 /** An AbShape Right Arrow with filled tip
  *
  *  size: width of the arrow.  Tip is a triangle with width=1/2 size.
@@ -110,6 +220,7 @@ int abShapeCheck(const AbShape *shape, const Vec2 *centerPos, const Vec2 *pixelL
 typedef struct AbRArrow_s {
   void (*getBounds)(const struct AbRArrow_s *shape, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbRArrow_s *shape, const Vec2 *centerPos, const Vec2 *pixelLoc);
+  int (*spans)(const struct AbRArrow_s *shape, const Vec2 *centerPos, int row, Span *spans);
   int size;
 } AbRArrow;
 
@@ -121,6 +232,10 @@ void abRArrowGetBounds(const AbRArrow *arrow, const Vec2 *centerPos, Region *bou
  */
 int abRArrowCheck(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** As required by AbShape
+ */
+int abRArrowSpans(const AbRArrow *arrow, const Vec2 *centerPos, int row, Span *spans);
+
 /** AbShape rectangle
  *
  *  Vector halfSize must be to first quadrant (both axes non-negative).
@@ -129,6 +244,7 @@ int abRArrowCheck(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixe
 typedef struct AbRect_s {
   void (*getBounds)(const struct AbRect_s *rect, const Vec2 *centerPos, Region *bounds);
   int (*check)(const struct AbRect_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*spans)(const struct AbRect_s *shape, const Vec2 *centerPos, int row, Span *spans);
   const Vec2 halfSize;
 } AbRect;
 
@@ -140,6 +256,10 @@ void abRectGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *bounds);
  */
 int abRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** As required by AbShape
+ */
+int abRectSpans(const AbRect *rect, const Vec2 *centerPos, int row, Span *spans);
+
 typedef AbRect AbRectOutline;	/* same as AbRect */
 
 /** As required by AbShape
@@ -150,6 +270,184 @@ void abRectOutlineGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *b
  */
 int abRectOutlineCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** As required by AbShape
+ */
+int abRectOutlineSpans(const AbRect *rect, const Vec2 *centerPos, int row, Span *spans);
+
+/** AbShape with an arbitrary silhouette, from a 1 bit per pixel mask
+ *
+ *  bits holds size.axes[1] rows of (size.axes[0] + 7) / 8 bytes, the
+ *  leftmost pixel in the top bit of a row's first byte, set where the
+ *  shape covers: the layout of a binary PBM (P4) image.  makeBitmap
+ *  converts PBM files.  Pixel (size / 2) of the mask is at centerPos.
+ */
+typedef struct AbBitmap_s {
+  void (*getBounds)(const struct AbBitmap_s *bitmap, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbBitmap_s *bitmap, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*spans)(const struct AbBitmap_s *bitmap, const Vec2 *centerPos, int row, Span *spans);
+  const Vec2 size;		/**< width, height in pixels */
+  const u_char *bits;
+} AbBitmap;
+
+/** As required by AbShape
+ */
+void abBitmapGetBounds(const AbBitmap *bitmap, const Vec2 *centerPos, Region *bounds);
+
+/** As required by AbShape: one bit test
+ */
+int abBitmapCheck(const AbBitmap *bitmap, const Vec2 *centerPos, const Vec2 *pixel);
+
+/** As required by AbShape.  Returns -1 for rows with more than
+ *  SHAPE_MAX_SPANS runs, which renderers then probe with check.
+ */
+int abBitmapSpans(const AbBitmap *bitmap, const Vec2 *centerPos, int row, Span *spans);
+
+/** Inline bodies of the shapes above
+ *
+ *  The AbShape functions are wrappers around these.  Renderers built
+ *  with layerRender.h call them directly for the shape types a scene
+ *  lists, saving the indirect call and the vec2 helper calls per span.
+ */
+static inline void
+abRArrowGetBoundsInline(const AbRArrow *arrow, const Vec2 *centerPos, Region *bounds)
+{
+  int size = arrow->size, halfSize = size / 2;
+  bounds->topLeft.axes[0] = centerPos->axes[0] - size;
+  bounds->topLeft.axes[1] = centerPos->axes[1] - halfSize;
+  bounds->botRight.axes[0] = centerPos->axes[0];
+  bounds->botRight.axes[1] = centerPos->axes[1] + halfSize;
+}
+
+static inline int
+abRArrowCheckInline(const AbRArrow *arrow, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int size = arrow->size, halfSize = size / 2, quarterSize = halfSize / 2;
+  int row = pixel->axes[1] - centerPos->axes[1];
+  int col = centerPos->axes[0] - pixel->axes[0]; /* note that col is negated */
+  row = (row >= 0) ? row : -row;	/* row = |row| */
+  if (col < 0)			/* to right of arrow */
+    return 0;
+  if (col <= halfSize)		/* within arrow tip */
+    return row <= col;
+  return col <= size && row <= quarterSize; /* within arrow stem */
+}
+
+static inline int
+abRArrowSpansInline(const AbRArrow *arrow, const Vec2 *centerPos, int row, Span *spans)
+{
+  int size = arrow->size, halfSize = size / 2, quarterSize = halfSize / 2;
+  int dRow = row - centerPos->axes[1];
+  dRow = (dRow >= 0) ? dRow : -dRow;	/* dRow = |dRow| */
+  if (dRow > halfSize)
+    return 0;
+  spans[0].start = centerPos->axes[0] - (dRow <= quarterSize ? size : halfSize);
+  spans[0].end = centerPos->axes[0] - dRow;
+  return 1;
+}
+
+static inline void
+abRectGetBoundsInline(const AbRect *rect, const Vec2 *centerPos, Region *bounds)
+{
+  bounds->topLeft.axes[0] = centerPos->axes[0] - rect->halfSize.axes[0];
+  bounds->topLeft.axes[1] = centerPos->axes[1] - rect->halfSize.axes[1];
+  bounds->botRight.axes[0] = centerPos->axes[0] + rect->halfSize.axes[0];
+  bounds->botRight.axes[1] = centerPos->axes[1] + rect->halfSize.axes[1];
+}
+
+static inline int
+abRectCheckInline(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int dCol = pixel->axes[0] - centerPos->axes[0];
+  int dRow = pixel->axes[1] - centerPos->axes[1];
+  int halfCols = rect->halfSize.axes[0], halfRows = rect->halfSize.axes[1];
+  return dCol <= halfCols && dCol >= -halfCols
+    && dRow <= halfRows && dRow >= -halfRows;
+}
+
+static inline int
+abRectSpansInline(const AbRect *rect, const Vec2 *centerPos, int row, Span *spans)
+{
+  int dRow = row - centerPos->axes[1], halfRows = rect->halfSize.axes[1];
+  if (dRow > halfRows || dRow < -halfRows)
+    return 0;
+  spans[0].start = centerPos->axes[0] - rect->halfSize.axes[0];
+  spans[0].end = centerPos->axes[0] + rect->halfSize.axes[0];
+  return 1;
+}
+
+#define abRectOutlineGetBoundsInline abRectGetBoundsInline
+
+static inline int
+abRectOutlineCheckInline(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int left = centerPos->axes[0] - rect->halfSize.axes[0];
+  int right = centerPos->axes[0] + rect->halfSize.axes[0];
+  int top = centerPos->axes[1] - rect->halfSize.axes[1];
+  int bottom = centerPos->axes[1] + rect->halfSize.axes[1];
+  int col = pixel->axes[0], row = pixel->axes[1];
+  return (((col == left || col == right) && row >= top && row <= bottom)
+	  || ((row == top || row == bottom) && col >= left && col <= right));
+}
+
+static inline int
+abRectOutlineSpansInline(const AbRect *rect, const Vec2 *centerPos, int row, Span *spans)
+{
+  int dRow = row - centerPos->axes[1], halfRows = rect->halfSize.axes[1];
+  int left = centerPos->axes[0] - rect->halfSize.axes[0];
+  int right = centerPos->axes[0] + rect->halfSize.axes[0];
+  if (dRow > halfRows || dRow < -halfRows)
+    return 0;
+  spans[0].start = left;
+  if (dRow == halfRows || dRow == -halfRows || left == right) {
+    spans[0].end = right;
+    return 1;
+  }
+  spans[0].end = left;
+  spans[1].start = spans[1].end = right;
+  return 2;
+}
+
+/** Layer storage layout
+ *
+ *  By default layers hold Vec2 positions and raw colors.  Compiling
+ *  shapeLib and the program with -DSHAPE_COMPACT stores positions as
+ *  LayerVec, 8 bits per axis (0..255: on or right of / below the
+ *  screen's origin), and colors as an index into layerPalette, which
+ *  the program defines: 20 bytes a layer instead of 26.  Code that
+ *  reads positions with LAYER_VEC2, colors with LAYER_COLOR and
+ *  initializes colors with LAYER_INK builds either way.  A raw color
+ *  in a compact Layer initializer is still valid C (truncated to a
+ *  u_char, which -Woverflow reports for most colors): "make compact"
+ *  builds with -Werror=overflow to stop those.
+ */
+#ifdef SHAPE_COMPACT
+typedef struct {
+  u_char axes[2];
+} LayerVec;
+typedef u_char LayerColor;	/**< index into layerPalette */
+
+/** Colors of LayerColor indices, defined by the program */
+extern const u_int layerPalette[];
+
+/** A layer color for an initializer: index in compact builds */
+#define LAYER_INK(index, color) (index)
+#define LAYER_COLOR(l) (layerPalette[(l)->color])
+/** lv as a const Vec2 *, copied through the Vec2 v */
+#define LAYER_VEC2(lv, v)						\
+  ((v).axes[0] = (lv).axes[0], (v).axes[1] = (lv).axes[1], (const Vec2 *)&(v))
+#else
+typedef Vec2 LayerVec;
+typedef u_int LayerColor;
+
+#define LAYER_INK(index, color) (color)
+#define LAYER_COLOR(l) ((l)->color)
+#define LAYER_VEC2(lv, v) ((void)&(v), (const Vec2 *)&(lv))
+#endif
+
+/** Store the Vec2 v in the LayerVec lv */
+#define LAYER_VEC_SET(lv, v)						\
+  ((lv).axes[0] = (v).axes[0], (lv).axes[1] = (v).axes[1])
+
 /** Linked list of Layers.  
  * 
  *  Each layer contains
@@ -163,18 +461,40 @@ int abRectOutlineCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pi
        Whan a layer moves: only posNext should be changed.
  *   - the layer's color
  *   - next: a reference to the next layer behind this layer
+ *   - flags: LAYER_STATIC for a layer that never moves (optional)
+ *   - scratch fields the renderer fills in while drawing; leave them
+ *     out of initializers
+ *
+ *  Renderers draw the first LAYER_MAX_DEPTH layers of a list and ignore
+ *  the rest.
  */
 typedef struct Layer_s {
   AbShape *abShape;
-  Vec2 pos, posLast, posNext; /* initially just set pos */
-  u_int color;
+  LayerVec pos, posLast, posNext; /* initially just set pos */
+  LayerColor color;
   struct Layer_s *next;
+  u_char flags;			/* LAYER_STATIC, LAYER_BAKED */
+  u_char depth;			/* place in the next list, 0 in front */
+  struct Layer_s *scanNext;	/* renderer's pending/active list */
+  int scanTop, scanBottom;	/* rows the layer covers */
 } Layer;	
 
+#define LAYER_STATIC 1		/**< never moves: layerBakeStatic may bake it */
+#define LAYER_BAKED 2		/**< set by layerBakeStatic; renderers skip it */
+
+/** Most layers a list draws: depth is a u_char and 255 marks bgColor
+ *  in a LayerRun */
+#define LAYER_MAX_DEPTH 254
+
 /** Compute layer's bounding box.
  */
 void layerGetBounds(const Layer *l, Region *bounds);
 
+/** Set where a layer is drawn next from a fixed-point position,
+ *  rounded to the nearest pixel
+ */
+void layerSetPosFx(Layer *l, const Vec2Fx *pos);
+
 /**
   sets bounds into a consistent state
  */
@@ -185,6 +505,184 @@ void layerInit(Layer *layers);
  */
 void layerDraw(Layer *layers);
 
+/** Render all layers within area (inclusive of botRight).
+ *  Pixels that are not contained by a layer are set to bgColor.
+ */
+void layerDrawRegion(Layer *layers, const Region *area);
+
+/** Columns of one color, in a static layer or the background */
+typedef struct {
+  u_int color;
+  u_char length;
+  u_char depth;			/**< the static layer's place in the list, 255 for bgColor */
+} LayerRun;
+
+/** Rows from top until the next band's top, all alike */
+typedef struct {
+  u_char top;
+  u_char firstRun;		/**< runs that cover the row, left to right */
+} LayerBand;
+
+/** Static layers baked into run-length rows
+ *
+ *  Each band of rows that look alike holds one list of runs across the
+ *  screen; bands with the same runs share them.  Renderers take a
+ *  pixel's color from the runs unless a layer in front of the run's
+ *  layer covers it, so baked layers are never probed.
+ *
+ *  The program sizes it, e.g. to what its static layers bake to:
+ *
+ *    static LayerRun fieldRuns[9];
+ *    static LayerBand fieldBands[4];
+ *    static LayerBackground field = {fieldRuns, fieldBands, 9, 4};
+ */
+typedef struct {
+  LayerRun *runs;		/**< room for maxRuns (at most 255) */
+  LayerBand *bands;		/**< room for maxBands */
+  u_char maxRuns, maxBands;
+  u_char numRuns, numBands;
+} LayerBackground;
+
+/** The background renderers use; 0 (the default) for plain bgColor */
+extern const LayerBackground *layerBackground;
+
+/** Bake the list's LAYER_STATIC layers, over bgColor, into bg and
+ *  render with it from now on.  Static layers are marked LAYER_BAKED
+ *  and no longer probed; render the same list, so depths agree, and
+ *  bake again if a static layer or bgColor changes.
+ *
+ *  \return 1, or 0 if bg's maxRuns or maxBands is too small (then
+ *  layers render without a background, probing every layer)
+ */
+int layerBakeStatic(Layer *layers, LayerBackground *bg);
+
+/** Most rectangles a DirtyList holds; more force merges */
+#ifndef DIRTY_MAX
+#define DIRTY_MAX 4
+#endif
+
+/** Screen rectangles waiting to be redrawn
+ *
+ *  dirtyAdd coalesces: a rectangle is merged with one it touches when
+ *  their bounding box is no larger than the two areas together, and
+ *  otherwise split around the ones it overlaps, so no pixel is in two
+ *  rectangles.  When all DIRTY_MAX are in use, the two (the new one
+ *  included) whose bounding box wastes fewest pixels are merged; and
+ *  a piece that would take too many cuts is merged into the rectangle
+ *  it overlaps.  A merged rectangle may then overlap another.
+ *  dirtyFlush draws each rectangle once.
+ */
+typedef struct {
+  Region rects[DIRTY_MAX];
+  u_char count;
+  u_int pixelsPending;		/**< area passed to dirtyAdd since last flush */
+  u_int pixelsAdded;		/**< last flush: area passed to dirtyAdd */
+  u_int pixelsDrawn;		/**< last flush: area drawn after coalescing */
+} DirtyList;
+
+/** Empty the list and zero its counts */
+void dirtyInit(DirtyList *dirty);
+
+/** Mark region (clipped to the screen) as needing a redraw */
+void dirtyAdd(DirtyList *dirty, const Region *region);
+
+/** Mark what a layer's move from posLast to pos changed as needing a
+ *  redraw: its bounds at pos, then its bounds at posLast, which the
+ *  list cuts around them (dirtyAddMove) */
+void dirtyAddLayer(DirtyList *dirty, const Layer *layer);
+
+/** dirtyAddLayer for a shape whose bounds, and last bounds, the
+ *  caller already has: bounds, then boundsLast, go to dirtyAdd
+ */
+void dirtyAddMove(DirtyList *dirty, const Region *bounds, const Region *boundsLast);
+
+/** Render layers within each dirty rectangle, then empty the list
+ *  and record pixelsAdded and pixelsDrawn for the frame
+ */
+void dirtyFlush(DirtyList *dirty, Layer *layers);
+
+/** dirtyFlush, drawing each rectangle with draw instead of
+ *  layerDrawRegion, e.g. a renderer built with layerRender.h
+ */
+void dirtyFlushWith(DirtyList *dirty, Layer *layers,
+		    void (*draw)(Layer *layers, const Region *area));
+
+/** Edge of a screen tile, in pixels */
+#define TILE_SIZE 16
+#define TILE_COLS ((screenWidth + TILE_SIZE - 1) / TILE_SIZE)
+#define TILE_ROWS ((screenHeight + TILE_SIZE - 1) / TILE_SIZE)
+
+/** Most layers one tile can resolve (4 bit owners; 0 is bgColor) */
+#define TILE_MAX_LAYERS 15
+
+/** Screen tiles waiting to be redrawn, for scenes with many small
+ *  moving layers
+ *
+ *  Any number of layers can be added: each marks the tiles under its
+ *  old and new bounds, so the cost of a frame is bounded by the tiles
+ *  touched rather than by boxes merged across the screen.
+ *  tileMapFlush bins the layers by tile row, then draws each dirty
+ *  tile in one lcd_setArea: the layers over the tile are painted back
+ *  to front into a 4 bit per pixel owner buffer (128 bytes), which is
+ *  sent as runs of one color.  A tile with more than TILE_MAX_LAYERS
+ *  layers is drawn with layerDrawRegion instead.
+ */
+typedef struct {
+  u_int dirty[TILE_ROWS];	/**< bit c of row r: tile (c, r) */
+  u_char tilesDrawn;		/**< last flush */
+} TileMap;
+
+/** Mark no tiles dirty and zero tilesDrawn */
+void tileMapInit(TileMap *map);
+
+/** Mark the tiles region (clipped to the screen) touches */
+void tileMapAdd(TileMap *map, const Region *region);
+
+/** Mark the tiles under a layer's last and current bounds */
+void tileMapAddLayer(TileMap *map, const Layer *layer);
+
+/** Render layers within each dirty tile, then mark none dirty */
+void tileMapFlush(TileMap *map, Layer *layers);
+
+/** A hardware-scrolled band of screen rows
+ *
+ *  Screen rows top .. top+height-1 scroll; rows outside the band stay
+ *  fixed and are drawn with layerDrawRegion as usual.  Layers in the
+ *  band are positioned in logical rows that keep growing as the view
+ *  scrolls: logical row r is stored in frame-memory row
+ *  top + (r mod height) and is on screen while
+ *  offset <= r < offset + height.
+ *
+ *  Assumes a vertical orientation, where the LCD scrolls rows.
+ */
+typedef struct {
+  u_char top, height;		/**< screen rows that scroll */
+  int offset;			/**< logical row shown at top */
+} ScrollView;
+
+/** Set up the LCD's scrolling area and show logical row 0 at top */
+void scrollViewInit(ScrollView *view, u_char top, u_char height);
+
+/** Frame-memory row holding a logical row */
+int scrollViewMemRow(const ScrollView *view, int logicalRow);
+
+/** Scroll so that logical row offset is shown at the top of the band
+ *
+ *  Only the scroll start register is written.  exposed is set to the
+ *  logical rows that came into view (empty if none; all of the band
+ *  after a jump of height rows or more), which the caller should
+ *  draw with layerDrawScrolled.
+ */
+void scrollViewSet(ScrollView *view, int offset, Region *exposed);
+
+/** Render layers positioned in view's logical rows within area
+ *  (logical coordinates, inclusive of botRight).  Rows not in view are
+ *  skipped, and each row is written to the frame-memory row that
+ *  holds it.  Pixels that are not contained by a layer are set to
+ *  bgColor.
+ */
+void layerDrawScrolled(Layer *layers, const ScrollView *view, const Region *area);
+
 /** Background color.
   */
 extern u_int bgColor;		/*  background color */
@@ -3,32 +3,36 @@
 #include "lcddraw.h"
 #include "shape.h"
 
-AbRect rect10 = {abRectGetBounds, abRectCheck, 10,10};
-AbRArrow arrow30 = {abRArrowGetBounds, abRArrowCheck, 30};
+AbRect rect10 = {abRectGetBounds, abRectCheck, abRectSpans, 10,10};
+AbRArrow arrow30 = {abRArrowGetBounds, abRArrowCheck, abRArrowSpans, 30};
 
 
 Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}};
 
 
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {COLOR_BLACK, COLOR_RED, COLOR_ORANGE}; /**< LAYER_INK indices */
+#endif
+
 Layer layer2 = {
   (AbShape *)&arrow30,
   {screenWidth/2+40, screenHeight/2+10}, 	    /* position */
   {0,0}, {0,0},				    /* last & next pos */
-  COLOR_BLACK,
+  LAYER_INK(0, COLOR_BLACK),
   0,
 };
 Layer layer1 = {
   (AbShape *)&rect10,
   {screenWidth/2, screenHeight/2}, 	    /* position */
   {0,0}, {0,0},				    /* last & next pos */
-  COLOR_RED,
+  LAYER_INK(1, COLOR_RED),
   &layer2,
 };
 Layer layer0 = {
   (AbShape *)&rect10,
   {(screenWidth/2)+10, (screenHeight/2)+5}, /* position */
   {0,0}, {0,0},				    /* last & next pos */
-  COLOR_ORANGE,
+  LAYER_INK(2, COLOR_ORANGE),
   &layer1,
 };
 
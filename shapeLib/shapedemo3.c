@@ -17,25 +17,29 @@ abSlicedRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
     return abRectCheck(rect, centerPos, pixel);
 }
 
-AbRect rect10 = {abRectGetBounds, abSlicedRectCheck, 10,10};;
+AbRect rect10 = {abRectGetBounds, abSlicedRectCheck, 0, 10,10};; /* no spans: drawn with check */
 
 
 Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}};
 
 
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {COLOR_RED, COLOR_ORANGE}; /**< LAYER_INK indices */
+#endif
+
 #define numLayers 2
 Layer layer1 = {
   (AbShape *)&rect10,
   {screenWidth/2, screenHeight/2}, /* position */
   {0,0}, {0,0},				    /* last & next pos */
-  COLOR_RED,
+  LAYER_INK(0, COLOR_RED),
   0,
 };
 Layer layer0 = {
   (AbShape *)&rect10,
   {(screenWidth/2)+15, (screenHeight/2)+10}, /* position */
   {0,0}, {0,0},				    /* last & next pos */
-  COLOR_ORANGE,
+  LAYER_INK(1, COLOR_ORANGE),
   &layer1,
 };
 
@@ -0,0 +1,93 @@
+#include <msp430.h>
+#include <libTimer.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "shape.h"
+
+#ifdef SHAPE_COMPACT
+#error logical rows pass 255: build shapedemo4 with the default layout
+#endif
+
+#define HEADER_ROWS 16		/* fixed rows above the scrolling band */
+#define SPACING 36		/* logical rows between obstacles */
+#define NUM_OBSTACLES 5		/* enough to cover the band plus one */
+
+AbRect rect10 = {abRectGetBounds, abRectCheck, abRectSpans, 10,4};
+AbRect rect20 = {abRectGetBounds, abRectCheck, abRectSpans, 20,4};
+
+Layer obstacle4 = {
+  (AbShape *)&rect20,
+  {screenWidth/2, 4*SPACING},		    /* logical position */
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_GREEN,
+  0,
+};
+Layer obstacle3 = {
+  (AbShape *)&rect10,
+  {screenWidth-20, 3*SPACING},
+  {0,0}, {0,0},
+  COLOR_ORANGE,
+  &obstacle4,
+};
+Layer obstacle2 = {
+  (AbShape *)&rect20,
+  {30, 2*SPACING},
+  {0,0}, {0,0},
+  COLOR_RED,
+  &obstacle3,
+};
+Layer obstacle1 = {
+  (AbShape *)&rect10,
+  {screenWidth/2, SPACING},
+  {0,0}, {0,0},
+  COLOR_YELLOW,
+  &obstacle2,
+};
+Layer obstacle0 = {
+  (AbShape *)&rect20,
+  {screenWidth-30, 0},
+  {0,0}, {0,0},
+  COLOR_WHITE,
+  &obstacle1,
+};
+
+u_int bgColor = COLOR_BLUE;
+
+/** Scrolls a column of obstacles up the screen under a fixed header.
+ *  Each step writes the scroll start register and draws one new row.
+ */
+int
+main()
+{
+  ScrollView view;
+  Layer *l;
+
+  configureClocks();
+  lcd_init();
+  shapeInit();
+
+  clearScreen(COLOR_BLUE);
+  drawString5x7(4, 4, "scrolling", COLOR_WHITE, COLOR_BLUE);
+
+  scrollViewInit(&view, HEADER_ROWS, screenHeight - HEADER_ROWS);
+  layerInit(&obstacle0);
+  {
+    Region band = {{0, 0}, {screenWidth-1, view.height-1}};
+    layerDrawScrolled(&obstacle0, &view, &band);
+  }
+
+  for (;;) {
+    Region exposed;
+    for (l = &obstacle0; l; l = l->next) /* recycle obstacles gone off top */
+      if (l->pos.axes[1] + SPACING / 2 < view.offset)
+	l->pos.axes[1] += NUM_OBSTACLES * SPACING;
+    scrollViewSet(&view, view.offset + 1, &exposed);
+    layerDrawScrolled(&obstacle0, &view, &exposed);
+    if (view.offset >= 100 * view.height) { /* keep logical rows small; */
+      view.offset -= 100 * view.height;	    /* memory rows are unchanged */
+      for (l = &obstacle0; l; l = l->next)
+	l->pos.axes[1] -= 100 * view.height;
+    }
+    __delay_cycles(200000);
+  }
+}
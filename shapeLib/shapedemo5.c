@@ -0,0 +1,45 @@
+#include <libTimer.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "shape.h"
+#include "invader.h"		/* generated from invader.pbm by makeBitmap */
+
+AbRect rect10 = {abRectGetBounds, abRectCheck, abRectSpans, 10,10};
+
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {COLOR_RED, COLOR_GREEN, COLOR_WHITE}; /**< LAYER_INK indices */
+#endif
+
+Layer layer2 = {
+  (AbShape *)&rect10,
+  {screenWidth/2, screenHeight/2}, 	    /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  LAYER_INK(0, COLOR_RED),
+  0,
+};
+Layer layer1 = {
+  (AbShape *)&invader,
+  {screenWidth/2 - 6, screenHeight/2 - 6},  /* overlaps the square */
+  {0,0}, {0,0},				    /* last & next pos */
+  LAYER_INK(1, COLOR_GREEN),
+  &layer2,
+};
+Layer layer0 = {
+  (AbShape *)&invader,
+  {screenWidth/2, screenHeight/2 - 40},	    /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  LAYER_INK(2, COLOR_WHITE),
+  &layer1,
+};
+
+u_int bgColor = COLOR_BLUE;
+
+int
+main()
+{
+  configureClocks();
+  lcd_init();
+
+  layerInit(&layer0);
+  layerDraw(&layer0);
+}
@@ -0,0 +1,199 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+/** Owner of each pixel of the tile being drawn, two per byte (high
+ *  nibble first): 0 for bgColor, i for the tile's layer i - 1 (private)
+ */
+static u_char tileOwners[TILE_SIZE][TILE_SIZE / 2];
+
+void
+tileMapInit(TileMap *map)
+{
+  u_char row;
+  for (row = 0; row < TILE_ROWS; row++)
+    map->dirty[row] = 0;
+  map->tilesDrawn = 0;
+}
+
+void
+tileMapAdd(TileMap *map, const Region *region)
+{
+  Region r = *region;
+  int row, lastRow, firstCol;
+  u_int cols;
+  regionClipScreen(&r);
+  if (!regionArea(&r))
+    return;
+  firstCol = r.topLeft.axes[0] / TILE_SIZE;
+  cols = (0xffff >> (15 - (r.botRight.axes[0] / TILE_SIZE - firstCol))) << firstCol;
+  lastRow = r.botRight.axes[1] / TILE_SIZE;
+  for (row = r.topLeft.axes[1] / TILE_SIZE; row <= lastRow; row++)
+    map->dirty[row] |= cols;
+}
+
+void
+tileMapAddLayer(TileMap *map, const Layer *l)
+{
+  Region bounds;
+  Vec2 at;
+  abShapeGetBounds(l->abShape, LAYER_VEC2(l->posLast, at), &bounds);
+  tileMapAdd(map, &bounds);
+  abShapeGetBounds(l->abShape, LAYER_VEC2(l->pos, at), &bounds);
+  tileMapAdd(map, &bounds);
+}
+
+/** Chain the layers that overlap rows of band through scanNext, front
+ *  to back (private)
+ */
+static Layer *
+tileBin(Layer *layers, const Region *band)
+{
+  Layer *binned = 0, **tail = &binned, *l;
+  for (l = layers; l; l = l->next) {
+    Region bounds;
+    Vec2 at;
+    abShapeGetBounds(l->abShape, LAYER_VEC2(l->pos, at), &bounds);
+    if (bounds.botRight.axes[1] >= band->topLeft.axes[1]
+	&& bounds.topLeft.axes[1] <= band->botRight.axes[1]) {
+      *tail = l;
+      tail = &l->scanNext;
+    }
+  }
+  *tail = 0;
+  return binned;
+}
+
+/** Set the owner of tile columns start..end of an owner row (private) */
+static void
+tileSetOwner(u_char *owners, int start, int end, u_char owner)
+{
+  for (; start <= end; start++) {
+    u_char *pair = &owners[start >> 1];
+    if (start & 1)
+      *pair = (*pair & 0xf0) | owner;
+    else
+      *pair = (*pair & 0x0f) | (owner << 4);
+  }
+}
+
+/** Paint the pixels of tile that l covers with owner (private) */
+static void
+tilePaint(const Layer *l, u_char owner, const Region *tile)
+{
+  Region bounds;
+  Vec2 at;
+  const Vec2 *pos = LAYER_VEC2(l->pos, at);
+  int row, left = tile->topLeft.axes[0];
+  abShapeGetBounds(l->abShape, pos, &bounds);
+  regionIntersect(&bounds, &bounds, tile);
+  for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
+    u_char *owners = tileOwners[row - tile->topLeft.axes[1]];
+    Span spans[SHAPE_MAX_SPANS];
+    int n = abShapeSpans(l->abShape, pos, row, spans), i;
+    if (n < 0) {		/* no spans: check each pixel */
+      Vec2 pixelPos;
+      pixelPos.axes[1] = row;
+      for (i = bounds.topLeft.axes[0]; i <= bounds.botRight.axes[0]; i++) {
+	pixelPos.axes[0] = i;
+	if (abShapeCheck(l->abShape, pos, &pixelPos))
+	  tileSetOwner(owners, i - left, i - left, owner);
+      }
+      continue;
+    }
+    for (i = 0; i < n; i++) {
+      int start = spans[i].start, end = spans[i].end;
+      if (start < bounds.topLeft.axes[0])
+	start = bounds.topLeft.axes[0];
+      if (end > bounds.botRight.axes[0])
+	end = bounds.botRight.axes[0];
+      tileSetOwner(owners, start - left, end - left, owner);
+    }
+  }
+}
+
+/** Draw one tile from the binned layers over its rows (private)
+ *
+ *  \return 1 if it fell back to layerDrawRegion, which reuses scanNext
+ */
+static u_char
+tileDraw(Layer *layers, Layer *binned, const Region *tile)
+{
+  Layer *tileLayers[TILE_MAX_LAYERS], *l;
+  u_char n = 0, i;
+  int row, col, width = tile->botRight.axes[0] - tile->topLeft.axes[0] + 1;
+
+  for (l = binned; l; l = l->scanNext) {
+    Region bounds, interior;
+    Vec2 at;
+    const Vec2 *pos = LAYER_VEC2(l->pos, at);
+    u_char props;
+    abShapeGetBounds(l->abShape, pos, &bounds);
+    if (!regionOverlaps(&bounds, tile))
+      continue;
+    props = abShapeProps(l->abShape, pos, &interior);
+    if ((props & SHAPE_HOLLOW) && regionContains(&interior, tile))
+      continue;			/* the tile lies in its hole */
+    if (n == TILE_MAX_LAYERS) {	/* too many owners for a nibble */
+      layerDrawRegion(layers, tile);
+      return 1;
+    }
+    tileLayers[n++] = l;
+    if ((props & SHAPE_SOLID) && regionContains(&bounds, tile))
+      break;			/* hides the layers behind it */
+  }
+
+  lcd_setArea(tile->topLeft.axes[0], tile->topLeft.axes[1],
+	      tile->botRight.axes[0], tile->botRight.axes[1]);
+  if (!n) {
+    lcd_fillRun(bgColor, regionArea(tile));
+    return 0;
+  }
+  for (row = 0; row < TILE_SIZE; row++)
+    for (col = 0; col < TILE_SIZE / 2; col++)
+      tileOwners[row][col] = 0;
+  for (i = n; i--; )		/* back to front: the front layer wins */
+    tilePaint(tileLayers[i], i + 1, tile);
+
+  for (row = 0; row <= tile->botRight.axes[1] - tile->topLeft.axes[1]; row++) {
+    const u_char *owners = tileOwners[row];
+    for (col = 0; col < width; ) {
+      u_char owner = (owners[col >> 1] >> (col & 1 ? 0 : 4)) & 0x0f;
+      int runStart = col;
+      for (col++; col < width; col++)
+	if (((owners[col >> 1] >> (col & 1 ? 0 : 4)) & 0x0f) != owner)
+	  break;
+      lcd_fillRun(owner ? LAYER_COLOR(tileLayers[owner - 1]) : bgColor, col - runStart);
+    }
+  }
+  return 0;
+}
+
+void
+tileMapFlush(TileMap *map, Layer *layers)
+{
+  u_char row, col;
+  map->tilesDrawn = 0;
+  for (row = 0; row < TILE_ROWS; row++) {
+    u_int cols = map->dirty[row];
+    Region tile;
+    Layer *binned;
+    if (!cols)
+      continue;
+    tile.topLeft.axes[1] = row * TILE_SIZE;
+    tile.botRight.axes[1] = tile.topLeft.axes[1] + TILE_SIZE - 1;
+    tile.topLeft.axes[0] = 0;
+    tile.botRight.axes[0] = screenWidth - 1;
+    binned = tileBin(layers, &tile);
+    for (col = 0; cols; col++, cols >>= 1) {
+      if (!(cols & 1))
+	continue;
+      tile.topLeft.axes[0] = col * TILE_SIZE;
+      tile.botRight.axes[0] = tile.topLeft.axes[0] + TILE_SIZE - 1;
+      regionClipScreen(&tile);
+      if (tileDraw(layers, binned, &tile))
+	binned = tileBin(layers, &tile);
+      map->tilesDrawn++;
+    }
+    map->dirty[row] = 0;
+  }
+}
@@ -0,0 +1,142 @@
+/** \file tileprof.c
+ *  \brief Host profiler for many moving layers: DirtyList vs TileMap
+ *
+ *  Bounces a swarm of small particles and a few balls around the arena
+ *  and redraws each frame twice over: once through a DirtyList and
+ *  layerDrawRegion, once through a TileMap and tileMapFlush.  Bus
+ *  traffic per frame comes from the ST7735 emulator; the last frame of
+ *  each is written to tileprof-dirty.ppm and tileprof-tiles.ppm.
+ *
+ *  usage: tileprof [frames [particles]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "shape.h"
+#include "st7735emu.h"
+
+u_int bgColor = COLOR_BLACK;
+
+#define MAX_MOVERS 40
+
+const AbRect rectParticle = {abRectGetBounds, abRectCheck, abRectSpans, {1,1}};
+const AbRect rectBall = {abRectGetBounds, abRectCheck, abRectSpans, {3,3}};
+const AbRectOutline outlineField = {
+  abRectOutlineGetBounds, abRectOutlineCheck, abRectOutlineSpans,
+  {screenWidth/2 - 2, screenHeight/2 - 2}
+};
+
+static const u_int moverColors[] = {
+  COLOR_RED, COLOR_GREEN, COLOR_YELLOW, COLOR_CYAN, COLOR_MAGENTA, COLOR_ORANGE
+};
+#ifdef SHAPE_COMPACT
+const u_int layerPalette[] = {	/**< LAYER_INK indices: the field, then moverColors */
+  COLOR_WHITE, COLOR_RED, COLOR_GREEN, COLOR_YELLOW, COLOR_CYAN, COLOR_MAGENTA, COLOR_ORANGE
+};
+#endif
+
+Layer layerField = {
+  (AbShape *)&outlineField,
+  {screenWidth/2, screenHeight/2},
+  {0,0}, {0,0},
+  LAYER_INK(0, COLOR_WHITE),
+  0
+};
+
+static Layer movers[MAX_MOVERS];
+static Vec2 velocities[MAX_MOVERS];
+static int numMovers;
+
+
+/** Same start for both runs: balls first, then particles */
+static void
+sceneInit(int particles)
+{
+  int i;
+  srand(1);
+  numMovers = particles + 3;
+  for (i = 0; i < numMovers; i++) {
+    Layer *l = &movers[i];
+    l->abShape = (AbShape *)(i < 3 ? &rectBall : &rectParticle);
+    l->pos.axes[0] = 10 + rand() % (screenWidth - 20);
+    l->pos.axes[1] = 10 + rand() % (screenHeight - 20);
+    l->color = LAYER_INK(1 + i % 6, moverColors[i % 6]);
+    l->next = i + 1 < numMovers ? &movers[i + 1] : &layerField;
+    velocities[i].axes[0] = rand() % 5 - 2;
+    velocities[i].axes[1] = rand() % 5 - 2;
+    if (!velocities[i].axes[1])
+      velocities[i].axes[1] = 1;
+  }
+  layerInit(movers);
+}
+
+static void
+sceneMove()
+{
+  int i, axis;
+  for (i = 0; i < numMovers; i++) {
+    Layer *l = &movers[i];
+    for (axis = 0; axis < 2; axis++) {
+      int next = l->pos.axes[axis] + velocities[i].axes[axis];
+      int edge = axis ? screenHeight : screenWidth;
+      if (next < 6 || next > edge - 7)
+	velocities[i].axes[axis] = -velocities[i].axes[axis];
+      l->posNext.axes[axis] = l->pos.axes[axis] + velocities[i].axes[axis];
+    }
+    l->posLast = l->pos;
+    l->pos = l->posNext;
+  }
+}
+
+static DirtyList dirty;
+static TileMap tiles;
+
+/** Run the scene for frames, redrawing with tiles or a DirtyList */
+static int
+run(int frames, int particles, int useTiles)
+{
+  int frame, i;
+  unsigned long totalMicros = 0, worstMicros = 0, totalPixels = 0;
+
+  sceneInit(particles);
+  layerDraw(movers);
+  dirtyInit(&dirty);
+  tileMapInit(&tiles);
+  for (frame = 0; frame < frames; frame++) {
+    sceneMove();
+    st7735_resetStats();
+    if (useTiles) {
+      for (i = 0; i < numMovers; i++)
+	tileMapAddLayer(&tiles, &movers[i]);
+      tileMapFlush(&tiles, movers);
+    } else {
+      for (i = 0; i < numMovers; i++)
+	dirtyAddLayer(&dirty, &movers[i]);
+      dirtyFlush(&dirty, movers);
+    }
+    lcd_flush();
+    totalMicros += st7735_busMicros();
+    totalPixels += st7735_stats.pixels;
+    if (st7735_busMicros() > worstMicros)
+      worstMicros = st7735_busMicros();
+  }
+  if (frames)
+    printf("%s: %d movers, %d frames: mean %lu us, worst %lu us on the bus,"
+	   " %lu pixels per frame\n", useTiles ? "tiles" : "dirty", numMovers,
+	   frames, totalMicros / frames, worstMicros, totalPixels / frames);
+  return st7735_writePPM(useTiles ? "tileprof-tiles.ppm" : "tileprof-dirty.ppm");
+}
+
+int
+main(int argc, char **argv)
+{
+  int frames = argc > 1 ? atoi(argv[1]) : 60;
+  int particles = argc > 2 ? atoi(argv[2]) : 24;
+
+  if (particles > MAX_MOVERS - 3)
+    particles = MAX_MOVERS - 3;
+  lcd_init();
+  return run(frames, particles, 0) | run(frames, particles, 1);
+}
@@ -48,3 +48,30 @@ vec2Abs(Vec2 *vec)
       vec->axes[axis] = -val;
   }
 }
+
+void
+vec2FxAdd(Vec2Fx *result, const Vec2Fx *v1, const Vec2Fx *v2)
+{
+  u_char axis;
+  for (axis = 0; axis < 2; axis ++) {
+    result->axes[axis] = v1->axes[axis] + v2->axes[axis];
+  }
+}
+
+void
+vec2FxFromVec2(Vec2Fx *fx, const Vec2 *v)
+{
+  u_char axis;
+  for (axis = 0; axis < 2; axis ++) {
+    fx->axes[axis] = v->axes[axis] * FX_ONE;
+  }
+}
+
+void
+vec2FxRound(Vec2 *v, const Vec2Fx *fx)
+{
+  u_char axis;
+  for (axis = 0; axis < 2; axis ++) {
+    v->axes[axis] = FX_ROUND(fx->axes[axis]);
+  }
+}